@@ -4,35 +4,84 @@
 #include <ostream>
 #include <memory>
 #include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include "trace.hpp"
 #include "sortbase.hpp"
 #include "filesys.hpp"
+#include "perf.hpp"
 
 template<class ClockResolution>
 class BenchResult {
 public:
     using duration_t = std::chrono::duration<double, ClockResolution>;
 
-    BenchResult(const Trace& _trace, const duration_t& _duration) : trace(_trace), duration(_duration) {}
+    BenchResult(const TracePolicy& _trace, const duration_t& _duration, const PerfSample& _perf, bool _timeout = false,
+                std::size_t _unstable = 0)
+        : trace(_trace), duration(_duration), perf(_perf), timeout(_timeout), unstable(_unstable) {}
 
 public:
-    const Trace& trace;
+    const TracePolicy trace; // snapshot of this iteration only
     const duration_t duration;
+    const PerfSample perf; // hardware counters over run(), all -1 when not permitted
+    const bool timeout; // censored: cancelled by the watchdog, counts are partial and the data unsorted
+    const std::size_t unstable; // equal keys left out of their input order, records only
 };
 
 using SortingMethod = std::unique_ptr<SortBase>;
 
+class Watchdog { // cancels the sort once the budget elapses, disarmed on destruction
+public:
+    template<class Duration>
+    Watchdog(SortingMethod& _sort, const Duration& _budget)
+        : thread([this, &_sort, _budget]() {
+              std::unique_lock<std::mutex> lock(mtx);
+              if (!cv.wait_for(lock, _budget, [this]() { return done; })) _sort->cancel();
+          }) {}
+    ~Watchdog() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            done = true;
+        }
+        cv.notify_all();
+        thread.join();
+    }
+
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+private:
+    std::mutex mtx; // declared before the thread that waits on them
+    std::condition_variable cv;
+    bool done = false;
+    std::thread thread;
+};
+
+// _budget: wall-clock limit of run(), zero for none
 template<class ClockResolution>
-BenchResult<ClockResolution> benchmark(SortingMethod& sort) {
+BenchResult<ClockResolution> benchmark(SortingMethod& sort, PerfGroup& perf,
+                                       std::chrono::duration<double> _budget = std::chrono::duration<double>::zero()) {
+    sort->reset_trace(); // counters cover a single run()
+    sort->cancel(false);
+    std::unique_ptr<Watchdog> watchdog; // armed outside the timed region, its thread start is not measured
+    if (_budget > _budget.zero()) watchdog = std::make_unique<Watchdog>(sort, _budget);
+    perf.start();
     auto begin = std::chrono::high_resolution_clock::now();
-    sort->run();
+    try { sort->run(); }
+    catch (const SortCancelled&) {
+        auto duration(std::chrono::high_resolution_clock::now() - begin);
+        return BenchResult<ClockResolution>(sort->trace(), duration, perf.stop(), true);
+    }
     auto duration(std::chrono::high_resolution_clock::now() - begin);
+    PerfSample sample = perf.stop();
+    watchdog.reset();
     if (!sort->validate()) {
         sort->validate(true); // verbose
         throw std::runtime_error("Sorted data do not match with the answer");
     }
-    return BenchResult<ClockResolution>(sort->trace(), duration);
+    return BenchResult<ClockResolution>(sort->trace(), duration, sample, false, sort->unstable());
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,360 @@
+#ifndef CONTAINER_HPP
+#define CONTAINER_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <algorithm>
+#include <stdexcept>
+
+#include "keys.hpp"
+#include "fingerprint.hpp"
+
+// self-describing dataset file: a fixed header, then the elements from a CONTAINER_ALIGN aligned offset,
+// either as they are in memory (mmap-able) or as delta-coded blocks
+constexpr char CONTAINER_MAGIC[8] = { 'S', 'B', 'E', 'N', 'C', 'H', '\x1A', '\n' };
+constexpr std::uint16_t CONTAINER_VERSION = 1;
+constexpr std::size_t CONTAINER_ALIGN = 64;
+constexpr std::size_t CONTAINER_BLOCK = 1 << 16;       // elements per compressed block
+constexpr std::size_t CONTAINER_READ_BLOCK = 1 << 20;  // bytes per read of an uncompressed payload
+
+enum ContainerFlag : std::uint32_t {
+    CONTAINER_COMPRESSED = 1 << 0, // payload is a sequence of ContainerBlock
+    CONTAINER_ANSWER     = 1 << 1, // sorted answer of its .unsorted counterpart
+};
+
+enum ContainerRng : std::uint8_t { RNG_MT19937 = 0, RNG_PHILOX = 1 };
+
+struct __attribute__((packed)) ContainerHeader {
+    char magic[8];
+    std::uint16_t version;
+    std::uint8_t kind;       // KeyKind
+    std::uint8_t rng;        // ContainerRng
+    std::uint16_t bsize;     // key bits
+    std::uint16_t payload;   // record bytes after the key
+    std::uint32_t flags;     // ContainerFlag
+    std::uint32_t generator; // datagen version, the same seed, version and generator block reproduce the same data
+    std::uint64_t size;      // #elements
+    std::uint64_t seed;
+    std::uint64_t block;     // elements per compressed block
+    std::uint64_t offset;    // first payload byte, CONTAINER_ALIGN aligned
+    std::uint64_t bytes;     // stored payload bytes
+    std::uint64_t checksum;  // Checksum of the decoded elements
+    char dist[16];
+    char pattern[16];
+    std::uint64_t gen_block; // elements per generator block (datagen --block), philox output depends on it; 0 if unknown
+    std::uint8_t reserved[16];
+
+    inline std::size_t width() const
+    { return bsize / 8 + payload; }
+
+    inline bool compressed() const
+    { return flags & CONTAINER_COMPRESSED; }
+
+    static std::string field(const char* _str, std::size_t _len)
+    { return std::string(_str, strnlen(_str, _len)); }
+};
+static_assert(sizeof(ContainerHeader) == 128 && sizeof(ContainerHeader) % CONTAINER_ALIGN == 0);
+
+struct __attribute__((packed)) ContainerBlock {
+    std::uint32_t count; // elements
+    std::uint32_t bytes; // stored bytes following this block header
+    std::uint8_t mode;   // 0: raw, 1: delta + zigzag varint
+    std::uint8_t reserved[7];
+};
+
+class Checksum { // order-dependent 64-bit hash over a byte stream fed in arbitrary pieces
+public:
+    void update(const std::uint8_t* _data, std::size_t _len) {
+        total += _len;
+        while (_len && fill) { // complete a word left over from the previous piece
+            carry[fill++] = *_data++; --_len;
+            if (fill == sizeof(std::uint64_t)) { absorb(carry); fill = 0; }
+        }
+        for (; _len >= sizeof(std::uint64_t); _len -= sizeof(std::uint64_t), _data += sizeof(std::uint64_t)) absorb(_data);
+        while (_len--) carry[fill++] = *_data++;
+    }
+
+    std::uint64_t value() const {
+        std::uint64_t h = state;
+        if (fill) {
+            std::uint64_t word = 0;
+            std::memcpy(&word, carry, fill);
+            h = mix64(h ^ word);
+        }
+        return mix64(h ^ total);
+    }
+
+private:
+    inline void absorb(const std::uint8_t* _word) {
+        std::uint64_t word;
+        std::memcpy(&word, _word, sizeof(word));
+        state = mix64(state ^ word) + 0x9E3779B97F4A7C15ull;
+    }
+
+private:
+    std::uint64_t state = 0;
+    std::uint64_t total = 0;
+    std::uint8_t carry[sizeof(std::uint64_t)];
+    std::size_t fill = 0;
+};
+
+// every element is split into lanes (the key, then 8-byte payload words); each lane stores the zigzag varint
+// of its difference to the previous element, so sorted keys and running indices shrink to a byte or two
+class DeltaCodec {
+public:
+    DeltaCodec(std::size_t _key_bytes, std::size_t _payload_bytes) {
+        lanes.push_back(_key_bytes);
+        for (std::size_t off = 0; off < _payload_bytes; off += sizeof(std::uint64_t))
+            lanes.push_back(std::min(sizeof(std::uint64_t), _payload_bytes - off));
+        for (auto lane : lanes) width += lane;
+    }
+
+    void encode(const std::uint8_t* _src, std::size_t _count, std::vector<std::uint8_t>& _out) const {
+        std::vector<std::uint64_t> prev(lanes.size(), 0);
+        for (std::size_t i = 0; i < _count; ++i) {
+            const std::uint8_t* p = _src + i * width;
+            for (std::size_t l = 0; l < lanes.size(); p += lanes[l++]) {
+                std::uint64_t v = load(p, lanes[l]);
+                std::int64_t d = extend((v - prev[l]) & mask(lanes[l]), lanes[l]);
+                prev[l] = v;
+                std::uint64_t zz = (std::uint64_t(d) << 1) ^ std::uint64_t(d >> 63);
+                while (zz >= 0x80) { _out.push_back(std::uint8_t(zz) | 0x80); zz >>= 7; }
+                _out.push_back(std::uint8_t(zz));
+            }
+        }
+    }
+
+    // false on a malformed block
+    bool decode(const std::uint8_t* _src, std::size_t _len, std::size_t _count, std::uint8_t* _dst) const {
+        std::vector<std::uint64_t> prev(lanes.size(), 0);
+        const std::uint8_t* end = _src + _len;
+        for (std::size_t i = 0; i < _count; ++i) {
+            std::uint8_t* p = _dst + i * width;
+            for (std::size_t l = 0; l < lanes.size(); p += lanes[l++]) {
+                std::uint64_t zz = 0;
+                for (int shift = 0;; shift += 7) {
+                    if (_src == end || shift > 63) return false;
+                    std::uint8_t byte = *_src++;
+                    zz |= std::uint64_t(byte & 0x7F) << shift;
+                    if (!(byte & 0x80)) break;
+                }
+                std::int64_t d = std::int64_t(zz >> 1) ^ -std::int64_t(zz & 1);
+                prev[l] = (prev[l] + std::uint64_t(d)) & mask(lanes[l]);
+                std::memcpy(p, &prev[l], lanes[l]);
+            }
+        }
+        return _src == end;
+    }
+
+private:
+    static inline std::uint64_t load(const std::uint8_t* _p, std::size_t _bytes) {
+        std::uint64_t v = 0;
+        std::memcpy(&v, _p, _bytes);
+        return v;
+    }
+
+    static inline std::uint64_t mask(std::size_t _bytes)
+    { return _bytes >= sizeof(std::uint64_t) ? ~std::uint64_t(0) : (std::uint64_t(1) << (_bytes * 8)) - 1; }
+
+    static inline std::int64_t extend(std::uint64_t _v, std::size_t _bytes) { // sign of a lane-wide difference
+        const int shift = 64 - int(_bytes) * 8;
+        return std::int64_t(_v << shift) >> shift;
+    }
+
+private:
+    std::vector<std::size_t> lanes;
+    std::size_t width = 0;
+};
+
+// a header describing the elements, everything but the payload bookkeeping filled in
+inline ContainerHeader make_header(KeyKind _kind, std::uint16_t _bsize, std::uint16_t _payload, std::uint64_t _size,
+                                   const std::string& _dist, const std::string& _pattern) {
+    ContainerHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CONTAINER_MAGIC, sizeof(header.magic));
+    header.version = CONTAINER_VERSION;
+    header.kind = std::uint8_t(_kind);
+    header.bsize = _bsize;
+    header.payload = _payload;
+    header.size = _size;
+    header.block = CONTAINER_BLOCK;
+    header.offset = (sizeof(ContainerHeader) + CONTAINER_ALIGN - 1) / CONTAINER_ALIGN * CONTAINER_ALIGN;
+    std::memcpy(header.dist, _dist.data(), std::min(_dist.size(), sizeof(header.dist))); // NUL-padded, not terminated
+    std::memcpy(header.pattern, _pattern.data(), std::min(_pattern.size(), sizeof(header.pattern)));
+    return header;
+}
+
+// the header of _filename if it is a container, nothing for a raw dataset
+inline std::optional<ContainerHeader> probe_container(const std::string& _filename) {
+    std::ifstream fin(_filename, std::ios::binary);
+    ContainerHeader header;
+    if (!fin.read(reinterpret_cast<char*>(&header), sizeof(header))) return std::nullopt;
+    if (std::memcmp(header.magic, CONTAINER_MAGIC, sizeof(header.magic)) != 0) return std::nullopt;
+    if (header.version > CONTAINER_VERSION) throw std::runtime_error("Unsupported container version " + std::to_string(header.version) + ": " + _filename);
+    if (header.offset % CONTAINER_ALIGN || header.offset < sizeof(header)) throw std::runtime_error("Malformed container header: " + _filename);
+    return header;
+}
+
+template<class T>
+class ContainerWriter { // counterpart of Stream, the header is completed when the writer is closed
+public:
+    ContainerWriter(const std::string& _filename, const ContainerHeader& _header)
+        : fout(_filename, std::ios::binary),
+          filename(_filename),
+          header(_header),
+          codec(_header.bsize / 8, _header.payload) {
+        if (!fout) throw std::runtime_error("Cannot open the file: " + _filename);
+        if (header.width() != sizeof(T)) throw std::invalid_argument("Container header does not describe the element type");
+        pending.reserve(header.compressed() ? header.block : CONTAINER_READ_BLOCK / sizeof(T));
+        fout.seekp(header.offset);
+    }
+    ~ContainerWriter() {
+        try { this->close(); }
+        catch (const std::exception& err) { std::cerr << err.what() << std::endl; }
+    }
+
+    ContainerWriter& operator<<(const T& _data) {
+        pending.push_back(_data);
+        if (pending.size() == pending.capacity()) [[unlikely]] this->flush();
+        return *this;
+    }
+
+    void flush() {
+        if (pending.empty()) return;
+        const std::uint8_t* raw = reinterpret_cast<const std::uint8_t*>(pending.data());
+        const std::size_t raw_bytes = pending.size() * sizeof(T);
+        checksum.update(raw, raw_bytes);
+        if (!header.compressed()) {
+            fout.write(reinterpret_cast<const char*>(raw), raw_bytes);
+            written += raw_bytes;
+        } else {
+            encoded.clear();
+            codec.encode(raw, pending.size(), encoded);
+            ContainerBlock block = {};
+            block.count = std::uint32_t(pending.size());
+            block.mode = encoded.size() < raw_bytes;  // incompressible blocks are kept raw
+            block.bytes = std::uint32_t(block.mode ? encoded.size() : raw_bytes);
+            fout.write(reinterpret_cast<const char*>(&block), sizeof(block));
+            fout.write(reinterpret_cast<const char*>(block.mode ? encoded.data() : raw), block.bytes);
+            written += sizeof(block) + block.bytes;
+        }
+        pending.clear();
+    }
+
+    void close() {
+        if (closed) return;
+        this->flush();
+        header.bytes = written;
+        header.checksum = checksum.value();
+        fout.seekp(0);
+        fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        fout.close();
+        closed = true;
+        if (!fout) throw std::runtime_error("Cannot write the file: " + filename);
+    }
+
+private:
+    std::ofstream fout;
+    const std::string filename;
+    ContainerHeader header;
+    const DeltaCodec codec;
+    Checksum checksum;
+    std::vector<T> pending;
+    std::vector<std::uint8_t> encoded;
+    std::size_t written = 0;
+    bool closed = false;
+};
+
+// completes the header of an uncompressed container whose payload was written in place, e.g. by several threads
+inline void seal_container(const std::string& _filename, ContainerHeader _header) {
+    std::fstream file(_filename, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file) throw std::runtime_error("Cannot open the file: " + _filename);
+    _header.bytes = _header.size * _header.width();
+    Checksum checksum;
+    std::vector<std::uint8_t> buffer(CONTAINER_READ_BLOCK);
+    file.seekg(_header.offset);
+    for (std::size_t left = _header.bytes; left > 0;) {
+        std::size_t len = std::min(left, buffer.size());
+        if (!file.read(reinterpret_cast<char*>(buffer.data()), len)) throw std::runtime_error("File is shorter than expected: " + _filename);
+        checksum.update(buffer.data(), len);
+        left -= len;
+    }
+    _header.checksum = checksum.value();
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+    if (!file) throw std::runtime_error("Cannot write the file: " + _filename);
+}
+
+class ContainerReader { // sequential decoder, the checksum is verified once the last element has been read
+public:
+    ContainerReader(const std::string& _filename)
+        : fin(_filename, std::ios::binary),
+          filename(_filename),
+          header(probe(_filename)),
+          codec(header.bsize / 8, header.payload) {
+        if (!fin) throw std::runtime_error("Cannot open the file: " + _filename);
+        this->rewind();
+    }
+
+    inline const ContainerHeader& info() const
+    { return header; }
+
+    void rewind() {
+        fin.clear();
+        fin.seekg(header.offset);
+        remaining = header.size;
+        checksum = Checksum();
+    }
+
+    // next run of whole elements into _out, false once the payload is exhausted
+    bool next(std::vector<std::uint8_t>& _out) {
+        if (remaining == 0) return false;
+        const std::size_t width = header.width();
+        if (!header.compressed()) {
+            const std::size_t count = std::min<std::size_t>(remaining, std::max<std::size_t>(CONTAINER_READ_BLOCK / width, 1));
+            _out.resize(count * width);
+            if (!fin.read(reinterpret_cast<char*>(_out.data()), _out.size())) throw std::runtime_error("File is shorter than expected: " + filename);
+        } else {
+            ContainerBlock block;
+            if (!fin.read(reinterpret_cast<char*>(&block), sizeof(block)) || block.count == 0 || block.count > remaining)
+                throw std::runtime_error("Malformed container block: " + filename);
+            _out.resize(std::size_t(block.count) * width);
+            if (block.mode == 0) {
+                if (block.bytes != _out.size() || !fin.read(reinterpret_cast<char*>(_out.data()), _out.size()))
+                    throw std::runtime_error("Malformed container block: " + filename);
+            } else {
+                encoded.resize(block.bytes);
+                if (!fin.read(reinterpret_cast<char*>(encoded.data()), encoded.size()) ||
+                    !codec.decode(encoded.data(), encoded.size(), block.count, _out.data()))
+                    throw std::runtime_error("Malformed container block: " + filename);
+            }
+        }
+        remaining -= _out.size() / width;
+        checksum.update(_out.data(), _out.size());
+        if (remaining == 0 && checksum.value() != header.checksum) throw std::runtime_error("Checksum mismatch: " + filename);
+        return true;
+    }
+
+private:
+    static ContainerHeader probe(const std::string& _filename) {
+        auto header = probe_container(_filename);
+        if (!header) throw std::runtime_error("Not a dataset container: " + _filename);
+        return *header;
+    }
+
+private:
+    std::ifstream fin;
+    const std::string filename;
+    const ContainerHeader header;
+    const DeltaCodec codec;
+    Checksum checksum;
+    std::vector<std::uint8_t> encoded;
+    std::uint64_t remaining = 0;
+};
+
+#endif
@@ -10,9 +10,23 @@
 #include <regex>
 #include <vector>
 #include <cstdint>
+#include <cstring>
+#include <memory>
 #include <exception>
+#include <atomic>
+#include <optional>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "keys.hpp"
+#include "fingerprint.hpp"
+#include "container.hpp"
 
 constexpr std::size_t STREAM_BLOCK_SIZE = 8192;
+constexpr std::size_t VALIDATE_BLOCK_SIZE = 1 << 20;
 
 std::size_t parse_suffix(const std::string&);
 std::string resolve_duplicated(const std::filesystem::path&, const std::string&);
@@ -37,90 +51,300 @@ public:
 
     void flush() {
         fout.write(reinterpret_cast<const char*>(block.data()), cnt * sizeof(T));
+        written += cnt * sizeof(T);
         cnt = 0;
     }
 
+    inline std::size_t bytes() const
+    { return written; }
+
 private:
     std::ofstream fout;
     const std::size_t max_cnt;
     std::size_t cnt = 0;
+    std::size_t written = 0;
+    std::vector<T> block;
+};
+
+template<class T>
+class Source { // block-buffered reader, counterpart of Stream
+public:
+    // _count elements from byte _offset on, everything up to the end of the file by default
+    Source(const std::string& _filename, std::size_t _offset = 0, std::size_t _count = SIZE_MAX)
+        : fin(_filename, std::ios::binary),
+          max_cnt(STREAM_BLOCK_SIZE / sizeof(T)),
+          left(_count),
+          block(max_cnt) {
+        if (!fin) throw std::runtime_error("Cannot open the file: " + _filename);
+        fin.seekg(_offset, std::ios::beg);
+    }
+
+    // the elements of a compressed container, decoded block by block
+    Source(std::unique_ptr<ContainerReader> _reader)
+        : max_cnt(0),
+          left(_reader->info().size),
+          reader(std::move(_reader)) {}
+
+    Source& operator>>(T& _data) {
+        if (pos >= cnt) [[unlikely]] this->fill();
+        if (pos < cnt) [[likely]] _data = block[pos++];
+        else good = false;
+        return *this;
+    }
+
+    explicit operator bool() const
+    { return good; }
+
+    void fill() {
+        if (reader) {
+            cnt = reader->next(chunk) ? chunk.size() / sizeof(T) : 0;
+            block.resize(cnt);
+            std::memcpy(block.data(), chunk.data(), cnt * sizeof(T));
+        } else {
+            fin.read(reinterpret_cast<char*>(block.data()), std::min(max_cnt, left) * sizeof(T));
+            cnt = static_cast<std::size_t>(fin.gcount()) / sizeof(T);
+        }
+        read += cnt * sizeof(T); // decoded bytes for a container
+        left -= cnt;
+        pos = 0;
+    }
+
+    inline std::size_t bytes() const
+    { return read; }
+
+private:
+    std::ifstream fin;
+    const std::size_t max_cnt;
+    std::size_t left; // elements not yet read
+    std::size_t cnt = 0;
+    std::size_t pos = 0;
+    std::size_t read = 0;
+    bool good = true;
     std::vector<T> block;
+    std::unique_ptr<ContainerReader> reader; // set for a compressed container
+    std::vector<std::uint8_t> chunk;         // its decoded block
+};
+
+class TempDir { // scratch directory removed with everything in it on destruction
+public:
+    TempDir(const std::string& _prefix, const std::filesystem::path& _parent = std::filesystem::temp_directory_path()) {
+        static std::atomic<std::size_t> serial = 0; // scheduler jobs create theirs concurrently
+        do {
+            dir = _parent / (_prefix + "-" + std::to_string(::getpid()) + "-" + std::to_string(serial++));
+        } while (!std::filesystem::create_directory(dir));
+    }
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+    }
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    inline std::filesystem::path operator/(const std::string& _name) const
+    { return dir / _name; }
+
+private:
+    std::filesystem::path dir;
+};
+
+class MappedFile { // read-only view of a file, pages are shared with the page cache
+public:
+    MappedFile(const std::string& _filename, std::size_t _size)
+        : length(_size) {
+        fd = ::open(_filename.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Cannot open the file: " + _filename);
+        struct stat st;
+        if (::fstat(fd, &st) < 0 || static_cast<std::size_t>(st.st_size) < length) {
+            ::close(fd);
+            throw std::runtime_error("File is shorter than expected: " + _filename);
+        }
+        if (length == 0) return;
+        void* addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map the file: " + _filename);
+        }
+        ::madvise(addr, length, MADV_WILLNEED);
+        image = static_cast<const std::uint8_t*>(addr);
+    }
+    ~MappedFile() {
+        if (image) ::munmap(const_cast<std::uint8_t*>(image), length);
+        ::close(fd);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    inline const std::uint8_t* data(void) const
+    { return image; }
+
+    inline std::size_t size(void) const
+    { return length; }
+
+private:
+    int fd = -1;
+    const std::uint8_t* image = nullptr;
+    const std::size_t length;
 };
 
 class Metadata {
+private:
+    // declared first so they exist before the other members are extracted from them
+    std::string source;  // the path the match below refers into
+    std::smatch matched; // per instance, several datasets can be mounted in one process
+
 public:
     Metadata(const std::string& _file)
-        : filename(ext_filename(_file)),
-          sorted(ext_sorted(_file)),
+        : source(_file),
+          container(probe_container(_file)),
+          filename(ext_filename(_file)),
+          answer(ext_sorted(_file)),
+          sidecar(ext_sidecar(_file)),
+          sorted(answer),
+          kind(ext_kind(_file)),
           bsize(ext_bsize(_file)),
+          payload(ext_payload(_file)),
+          width(bsize / 8 + payload),
           size(ext_size(_file)),
           dist(ext_dist(_file)),
           pattern(ext_pattern(_file)),
           id(ext_id(_file))
-    { if (!sorted) throw std::runtime_error("Cannot open sorted file" + ext_sorted(_file)); }
+    {
+        if (!sorted && !std::filesystem::exists(sidecar))
+            throw std::runtime_error("Cannot open sorted file " + answer + " nor its fingerprint " + sidecar);
+        // the header is read as it is, so kind, key bits and payload must still name an element type
+        if (container) {
+            try { visit_key_type(kind, bsize, payload, [](auto) {}); }
+            catch (const std::invalid_argument&) {
+                throw std::runtime_error("Unsupported element type in the container (kind " + std::to_string(container->kind) +
+                                         ", " + std::to_string(bsize) + "-bit keys, " + std::to_string(payload) +
+                                         " payload bytes): " + filename);
+            }
+        }
+    }
+
+    // element type as spelled in the filename, e.g. int32, sint64, float64p8
+    inline std::string type() const
+    { return kind_prefix(kind) + std::to_string(bsize) + (payload ? "p" + std::to_string(payload) : std::string()); }
 
 private:
+    // a container describes itself, then the filename only has to match for the id
     std::smatch& match(const std::string& _file) {
-        static const std::regex pattern(R"((?:.*/)?int(\d+)_(\d+)([KMBT]?)_([a-z]+)_([a-z]+)_(\d+).*)");
-        static const std::regex pattern_no_suffix(R"((?:.*/)?int(\d+)_(\d+)_([a-z]+)_([a-z]+)_(\d+).*)");
-        static std::smatch match;
-        static bool executed = false;
-        if (executed) return match;
+        // <int|sint|float><key bits>[p<payload bytes>]_<N>_<distribution>_<pattern>_<id>
+        static const std::regex pattern(R"((?:.*/)?(int|sint|float)(\d+)(?:p(\d+))?_(\d+)([KMBT]?)_([a-z]+)_([a-z]+)_(\d+).*)");
+        if (!matched.empty()) return matched;
 
-        if (!std::regex_search(_file, match, pattern))
+        if (!std::regex_search(source, matched, pattern) && !container)
             throw std::invalid_argument("Cannot extract metadata: " + _file);
-        
-        executed = true;
-        return match;
+        return matched;
     }
 
     std::string ext_filename(const std::string& _file) {
-        return match(_file)[0].str();
+        return match(_file).empty() ? source : match(_file)[0].str();
+    }
+
+    KeyKind ext_kind(const std::string& _file) {
+        if (container) return static_cast<KeyKind>(container->kind);
+        return parse_kind(match(_file)[1].str());
     }
 
     std::string ext_sorted(const std::string& _file) {
         return std::regex_replace(ext_filename(_file), std::regex(R"(^(.*)\.unsorted$)"), "$1.sorted");
     }
 
+    std::string ext_sidecar(const std::string& _file) {
+        return std::regex_replace(ext_filename(_file), std::regex(R"(^(.*)\.unsorted$)"), "$1.fingerprint");
+    }
+
     std::int16_t ext_bsize(const std::string& _file) {
-        return static_cast<std::int16_t>(std::stoi(match(_file)[1].str()));
+        if (container) return static_cast<std::int16_t>(container->bsize);
+        return static_cast<std::int16_t>(std::stoi(match(_file)[2].str()));
+    }
+
+    std::size_t ext_payload(const std::string& _file) {
+        if (container) return container->payload;
+        return match(_file)[3].matched ? std::stoull(match(_file)[3].str()) : 0;
     }
 
     std::size_t ext_size(const std::string& _file) {
-        return parse_suffix(match(_file)[2].str() + match(_file)[3].str());
+        if (container) return container->size;
+        return parse_suffix(match(_file)[4].str() + match(_file)[5].str());
     }
 
     std::string ext_dist(const std::string& _file) {
-        return match(_file)[4].str();
+        if (container) return ContainerHeader::field(container->dist, sizeof(container->dist));
+        return match(_file)[6].str();
     }
 
     std::string ext_pattern(const std::string& _file) {
-        return match(_file)[5].str();
+        if (container) return ContainerHeader::field(container->pattern, sizeof(container->pattern));
+        return match(_file)[7].str();
     }
 
     std::int16_t ext_id(const std::string& _file) {
-        return static_cast<std::int16_t>(std::stoi(match(_file)[6].str()));
+        if (match(_file).empty()) return 0; // container under a free-form name
+        return static_cast<std::int16_t>(std::stoi(match(_file)[8].str()));
     }
 
 public:
+    const std::optional<ContainerHeader> container; // header of a self-describing dataset, overrides the filename
     const std::string filename;
-    std::ifstream sorted;
-    const std::int16_t bsize;
+    const std::string answer;
+    const std::string sidecar; // count and multiset fingerprint, stands in for a missing answer
+    std::ifstream sorted;      // not open when the dataset was generated without its answer
+    const KeyKind kind;
+    const std::int16_t bsize;   // key bits
+    const std::size_t payload;  // record bytes following the key, 0 for bare keys
+    const std::size_t width;    // bytes per element
     const std::size_t size;
     const std::string dist;
     const std::string pattern;
     const std::int16_t id;
 };
 
+// ANSWER compares against the .sorted file, FINGERPRINT checks sortedness and the multiset against the sidecar,
+// AUTO takes the answer whenever it exists
+enum class Verify { AUTO, ANSWER, FINGERPRINT };
+
 class Mount {
 public:
-    Mount(const std::string& _filename)
+    // _mapped: keep the pristine input mapped read-only and restore it with memcpy on reset()
+    // _resident: false for out-of-core sorters, which stream the input themselves and deliver() their result
+    Mount(const std::string& _filename, bool _mapped = false, Verify _verify = Verify::AUTO, bool _resident = true)
         : meta(_filename),
           fin(_filename, std::ios::binary),
-          data(meta.size * meta.bsize / 8) {
+          resident(_resident) {
         if (!std::filesystem::exists(_filename)) throw std::runtime_error("No such a file: " + _filename);
         if (!fin) throw std::runtime_error("Cannot open the file: " + _filename);
-        fin.read(reinterpret_cast<char*>(data.data()), data.size());
+        if (_verify == Verify::ANSWER && !meta.sorted) throw std::runtime_error("Cannot open the file: " + meta.answer);
+        by_fingerprint = _verify == Verify::FINGERPRINT || (_verify == Verify::AUTO && !meta.sorted);
+        if (by_fingerprint) {
+            fingerprint = Fingerprint::load(meta.sidecar);
+            if (fingerprint.size() != meta.size) throw std::runtime_error("Fingerprint does not cover " + std::to_string(meta.size) + " elements: " + meta.sidecar);
+        } else {
+            answer_header = probe_container(meta.answer);
+            if (answer_header && (answer_header->size != meta.size || answer_header->width() != meta.width))
+                throw std::runtime_error("Answer does not describe the same elements: " + meta.answer);
+        }
+        if (!resident) {
+            fin.close();
+        } else if (meta.container && meta.container->compressed()) {
+            // decoded once, every reset() restores from memory as with a mapped input
+            ContainerReader reader(_filename);
+            std::vector<std::uint8_t> chunk;
+            while (reader.next(chunk)) pristine.insert(pristine.end(), chunk.begin(), chunk.end());
+            fin.close();
+        } else if (_mapped) {
+            image = std::make_unique<MappedFile>(_filename, start() + meta.size * meta.width);
+            fin.close();
+        }
+        this->reset();
+        if (resident && meta.container && !meta.container->compressed()) {
+            Checksum checksum;
+            checksum.update(data.data(), data.size());
+            if (checksum.value() != meta.container->checksum) throw std::runtime_error("Checksum mismatch: " + _filename);
+        }
     }
 
     template<class T>
@@ -139,38 +363,272 @@ public:
     { data.resize(data.size() + _additional); }
 
     void reset(void) {
-        data.resize(meta.size * meta.bsize / 8);
+        output.clear();
+        data.resize(resident ? meta.size * meta.width : 0); // nothing but the scratch space of an out-of-core sorter
+        if (!resident) return;
+        if (!pristine.empty()) {
+            std::memcpy(data.data(), pristine.data(), data.size());
+            return;
+        }
+        if (image) {
+            if (!data.empty()) std::memcpy(data.data(), image->data() + start(), data.size());
+            return;
+        }
         fin.clear();
-        fin.seekg(0, std::ios::beg);
+        fin.seekg(start(), std::ios::beg);
         fin.read(reinterpret_cast<char*>(data.data()), data.size());
     }
 
+    inline bool mapped(void) const
+    { return image != nullptr; }
+
+    inline bool fingerprinted(void) const
+    { return by_fingerprint; }
+
+    inline bool is_resident(void) const
+    { return resident; }
+
+    // the elements streamed from the input file, for out-of-core sorters
+    template<class T>
+    Source<T> input(void) const {
+        if (meta.container && meta.container->compressed()) return Source<T>(std::make_unique<ContainerReader>(meta.filename));
+        return Source<T>(meta.filename, start(), meta.size);
+    }
+
+    // the sorted elements are in _file rather than in memory, validate() and unstable() read them from there
+    inline void deliver(const std::string& _file)
+    { output = _file; }
+
     bool validate(bool verbose = false) {
-        std::vector<std::uint8_t> sorted(meta.size * meta.bsize / 8);
-        meta.sorted.clear();
-        meta.sorted.seekg(0, std::ios::beg);
-        meta.sorted.read(reinterpret_cast<char*>(sorted.data()), sorted.size());
         if (verbose) {
-            for (size_t j = 0; j < meta.size; ++j)
-                std::cout << reinterpret_cast<std::uint32_t*>(data.data())[j] << std::endl;
+            scan([&](const std::uint8_t* _block, std::size_t _count) {
+                for (std::size_t j = 0; j < _count; ++j) std::cout << element(_block, j) << std::endl;
+            });
+        }
+        return by_fingerprint ? validate_fingerprint(verbose) : validate_answer(verbose);
+    }
+
+    // inversions among equal keys: pairs of records with the same key whose original positions, kept in the
+    // record payload, came out in the opposite order; zero for bare keys, where stability cannot be observed.
+    // Each run of equal keys is counted by merge sort over its positions, which holds one run in memory at a time
+    std::size_t unstable(void) {
+        std::size_t violations = 0;
+        visit_key_type(meta.kind, meta.bsize, meta.payload, [&](auto _tag) {
+            using T = typename decltype(_tag)::type;
+            if constexpr (is_record_v<T>) {
+                std::optional<key_type_t<T>> key; // key of the current run, across blocks
+                std::vector<std::uint64_t> run, buffer;
+                scan([&](const std::uint8_t* _block, std::size_t _count) {
+                    const T* sorted = reinterpret_cast<const T*>(_block);
+                    for (std::size_t i = 0; i < _count; ++i) {
+                        if (!key || !(*key == key_of(sorted[i]))) {
+                            violations += inversions(run, buffer);
+                            run.clear();
+                            key = key_of(sorted[i]);
+                        }
+                        run.push_back(record_index(sorted[i]));
+                    }
+                });
+                violations += inversions(run, buffer);
+            }
+        });
+        return violations;
+    }
+
+private:
+    // pairs i < j with _a[i] > _a[j], counted while merge sorting _a bottom-up through _buffer
+    static std::size_t inversions(std::vector<std::uint64_t>& _a, std::vector<std::uint64_t>& _buffer) {
+        std::size_t count = 0;
+        const std::size_t n = _a.size();
+        _buffer.resize(n);
+        for (std::size_t width = 1; width < n; width *= 2) {
+            for (std::size_t low = 0; low < n; low += 2 * width) {
+                const std::size_t mid = std::min(low + width, n), high = std::min(low + 2 * width, n);
+                std::size_t i = low, j = mid, k = low;
+                while (i < mid && j < high) {
+                    if (_a[j] < _a[i]) { count += mid - i; _buffer[k++] = _a[j++]; }
+                    else _buffer[k++] = _a[i++];
+                }
+                while (i < mid) _buffer[k++] = _a[i++];
+                while (j < high) _buffer[k++] = _a[j++];
+            }
+            _a.swap(_buffer);
+        }
+        return count;
+    }
+
+    // first element byte of the input file
+    inline std::size_t start(void) const
+    { return meta.container ? meta.container->offset : 0; }
+
+    // _length bytes of the sorted elements from _offset on, requested in ascending order: straight from data,
+    // or read from the file an out-of-core sorter delivered
+    const std::uint8_t* result(std::size_t _offset, std::size_t _length) {
+        if (output.empty()) return data.data() + _offset;
+        if (_offset == 0) {
+            delivered.close();
+            delivered.clear();
+            delivered.open(output, std::ios::binary);
+        }
+        result_block.resize(_length);
+        if (!delivered.read(reinterpret_cast<char*>(result_block.data()), _length))
+            throw std::runtime_error("File is shorter than expected: " + output);
+        return result_block.data();
+    }
+
+    // calls _f(block, count) over the sorted elements, VALIDATE_BLOCK_SIZE bytes of whole elements at a time
+    template<class F>
+    void scan(F&& _f) {
+        const std::size_t bytes = meta.size * meta.width;
+        const std::size_t step = VALIDATE_BLOCK_SIZE / meta.width * meta.width;
+        for (std::size_t offset = 0; offset < bytes; offset += step) {
+            const std::size_t length = std::min(step, bytes - offset);
+            _f(result(offset, length), length / meta.width);
+        }
+    }
+
+    // compares against the answer block by block, so no second full-size buffer is needed; blocks whose keys
+    // match but whose bytes differ are fingerprinted on both sides, so payloads lost or duplicated among equal
+    // keys still fail while any order of them passes
+    bool validate_answer(bool verbose) {
+        const std::size_t bytes = meta.size * meta.width;
+        const std::size_t step = VALIDATE_BLOCK_SIZE / meta.width * meta.width; // whole elements per block
+        const std::size_t skip = answer_header ? answer_header->offset : 0;
+        // a container answer is decoded, checksum included, unless it can be mapped as it is
+        const bool decode = answer_header && !(image && !answer_header->compressed());
+        if (decode) {
+            if (!reader) reader = std::make_unique<ContainerReader>(meta.answer);
+            reader->rewind();
+        } else if (image) {
+            if (!answer) answer = std::make_unique<MappedFile>(meta.answer, skip + bytes);
+        } else {
+            block.resize(std::min(step, bytes));
+            meta.sorted.clear();
+            meta.sorted.seekg(skip, std::ios::beg);
+        }
+        Fingerprint expected_moved, actual_moved;
+        for (std::size_t offset = 0, length = 0; offset < bytes; offset += length) {
+            const std::uint8_t* expected;
+            if (decode) {
+                if (!reader->next(block)) throw std::runtime_error("File is shorter than expected: " + meta.answer);
+                length = block.size();
+                expected = block.data();
+            } else if (answer) {
+                length = std::min(step, bytes - offset);
+                expected = answer->data() + skip + offset;
+            } else {
+                length = std::min(step, bytes - offset);
+                meta.sorted.read(reinterpret_cast<char*>(block.data()), length);
+                expected = block.data();
+            }
+            const std::uint8_t* actual = result(offset, length);
+            if (std::memcmp(expected, actual, length) == 0) [[likely]] continue;
+            // bytes differ, keys may still match: payloads of equal keys, or -0.0 against +0.0
+            std::size_t index = mismatch(expected, actual, length / meta.width);
+            if (index == length / meta.width) {
+                expected_moved.add(expected, length / meta.width, meta.width);
+                actual_moved.add(actual, length / meta.width, meta.width);
+                continue;
+            }
+            if (verbose) {
+                std::cout << "Sorted[" << index + offset / meta.width << "] = " << element(actual, index) << "\n";
+                std::cout << "Answer[" << index + offset / meta.width << "] = " << element(expected, index) << std::endl;
+            }
+            return false;
+        }
+        if (actual_moved != expected_moved) {
+            if (verbose) std::cout << "Payloads of equal keys differ from the answer" << std::endl;
+            return false;
         }
-        for (size_t i = 0; i < sorted.size(); ++i) {
-            if (sorted[i] != data[i]) {
+        return true;
+    }
+
+    // one linear pass for the order and the multiset; equal keys may come in any order
+    bool validate_fingerprint(bool verbose) {
+        Fingerprint actual;
+        std::vector<std::uint8_t> prev; // last element of the previous block
+        std::size_t done = 0;
+        bool ascending = true;
+        scan([&](const std::uint8_t* _block, std::size_t _count) {
+            if (!ascending) return;
+            std::size_t index = descent(_block, _count, prev.empty() ? nullptr : prev.data());
+            if (index < _count) {
                 if (verbose) {
-                    std::cout << "Sorted[" << i / 4 << "] = " << reinterpret_cast<std::uint32_t*>(data.data())[i / 4] << "\n";
-                    std::cout << "Answer[" << i / 4 << "] = " << reinterpret_cast<std::uint32_t*>(sorted.data())[i / 4] << "\n";
+                    std::cout << "Sorted[" << done + index - 1 << "] = " << (index ? element(_block, index - 1) : element(prev.data(), 0)) << "\n";
+                    std::cout << "Sorted[" << done + index << "] = " << element(_block, index) << std::endl;
                 }
-                return false;
+                ascending = false;
+                return;
             }
+            actual.add(_block, _count, meta.width);
+            prev.assign(_block + (_count - 1) * meta.width, _block + _count * meta.width);
+            done += _count;
+        });
+        if (!ascending) return false;
+        if (actual != fingerprint) {
+            if (verbose) std::cout << "Fingerprint " << actual.str() << " differs from " << fingerprint.str() << std::endl;
+            return false;
         }
         return true;
     }
 
+    // first of the _count elements whose key is smaller than its predecessor's, _prev preceding the first one
+    // unless null; _count if the keys ascend
+    std::size_t descent(const std::uint8_t* _block, std::size_t _count, const std::uint8_t* _prev) const {
+        std::size_t index = _count;
+        visit_key_type(meta.kind, meta.bsize, meta.payload, [&](auto _tag) {
+            using T = typename decltype(_tag)::type;
+            const T* sorted = reinterpret_cast<const T*>(_block);
+            if (_prev && _count && key_of(sorted[0]) < key_of(*reinterpret_cast<const T*>(_prev))) { index = 0; return; }
+            for (std::size_t i = 1; i < _count; ++i)
+                if (key_of(sorted[i]) < key_of(sorted[i - 1])) { index = i; return; }
+        });
+        return index;
+    }
+
+    // key of the element, printed at its own width and signedness
+    std::string element(const std::uint8_t* _base, std::size_t _index) const {
+        std::string str;
+        visit_key_type(meta.kind, meta.bsize, meta.payload, [&](auto _tag) {
+            using T = typename decltype(_tag)::type;
+            auto key = key_of(reinterpret_cast<const T*>(_base)[_index]);
+            if constexpr (sizeof(key) == 1) str = std::to_string(int(key)); // not as a character
+            else str = std::to_string(key);
+        });
+        return str;
+    }
+
+    // first of _count elements whose keys differ, _count if none does
+    std::size_t mismatch(const std::uint8_t* _expected, const std::uint8_t* _actual, std::size_t _count) const {
+        std::size_t index = _count;
+        visit_key_type(meta.kind, meta.bsize, meta.payload, [&](auto _tag) {
+            using T = typename decltype(_tag)::type;
+            const T* expected = reinterpret_cast<const T*>(_expected);
+            const T* actual = reinterpret_cast<const T*>(_actual);
+            for (std::size_t i = 0; i < _count; ++i)
+                if (!(key_of(expected[i]) == key_of(actual[i]))) { index = i; return; }
+        });
+        return index;
+    }
+
 public:
     Metadata meta;
+    std::atomic<bool> cancelled = false; // raised by the watchdog, polled by every sorter working on this data
 
 private:
     std::ifstream fin;
+    std::unique_ptr<MappedFile> image;
+    std::unique_ptr<MappedFile> answer;
+    std::optional<ContainerHeader> answer_header; // set when the answer is a container
+    std::unique_ptr<ContainerReader> reader;      // decoder of such an answer
+    std::vector<std::uint8_t> block; // validation buffer for the streamed or decoded answer
+    std::vector<std::uint8_t> pristine; // decoded input of a compressed container
+    bool by_fingerprint = false;
+    Fingerprint fingerprint; // expected, from the sidecar
+    const bool resident;     // data holds the whole input
+    std::string output;      // result file of an out-of-core sorter, empty while the result is in data
+    std::ifstream delivered; // reader of that file
+    std::vector<std::uint8_t> result_block;
     std::vector<std::uint8_t> data;
 };
 
@@ -195,7 +653,7 @@ std::size_t parse_suffix(const std::string& str) {
 std::string resolve_duplicated(const std::filesystem::path& path, const std::string& base) {
     std::int16_t cnt = 0;
     auto format = [&](std::int16_t n) { return base + "_" + std::to_string(n); };
-    while (std::filesystem::exists(path / (format(++cnt) + ".sorted")));
+    while (std::filesystem::exists(path / (format(++cnt) + ".unsorted"))); // .sorted is optional
     return format(cnt);
 }
 
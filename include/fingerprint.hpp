@@ -0,0 +1,89 @@
+#ifndef FINGERPRINT_HPP
+#define FINGERPRINT_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include <algorithm>
+
+inline std::uint64_t mix64(std::uint64_t _x) { // splitmix64 finalizer
+    _x ^= _x >> 30; _x *= 0xBF58476D1CE4E5B9ull;
+    _x ^= _x >> 27; _x *= 0x94D049BB133111EBull;
+    return _x ^ (_x >> 31);
+}
+
+// order-independent hash of a multiset of fixed-width elements: every element is hashed on its own and the
+// hashes are summed (mod 2^64) in two independently seeded lanes, so any permutation keeps the fingerprint
+// while a lost, duplicated or altered element changes it
+class Fingerprint {
+public:
+    Fingerprint() {}
+
+    void add(const std::uint8_t* _element, std::size_t _width) {
+        ++count;
+        lane[0] += hash(_element, _width, 0x243F6A8885A308D3ull);
+        lane[1] += hash(_element, _width, 0x13198A2E03707344ull);
+    }
+
+    void add(const std::uint8_t* _elements, std::size_t _count, std::size_t _width) {
+        for (std::size_t i = 0; i < _count; ++i) add(_elements + i * _width, _width);
+    }
+
+    // sums commute, so fingerprints of disjoint blocks merge in any order
+    inline Fingerprint& operator+=(const Fingerprint& _other) {
+        count += _other.count;
+        lane[0] += _other.lane[0];
+        lane[1] += _other.lane[1];
+        return *this;
+    }
+
+    inline bool operator==(const Fingerprint& _other) const
+    { return count == _other.count && lane[0] == _other.lane[0] && lane[1] == _other.lane[1]; }
+
+    inline bool operator!=(const Fingerprint& _other) const
+    { return !(*this == _other); }
+
+    // sidecar text: "<count> <lane0 hex> <lane1 hex>"
+    std::string str() const {
+        std::ostringstream out;
+        out << count << " " << std::hex << std::setfill('0') << std::setw(16) << lane[0] << " " << std::setw(16) << lane[1];
+        return out.str();
+    }
+
+    void save(const std::string& _filename) const {
+        std::ofstream fout(_filename);
+        if (!(fout << str() << "\n")) throw std::runtime_error("Cannot write the file: " + _filename);
+    }
+
+    static Fingerprint load(const std::string& _filename) {
+        std::ifstream fin(_filename);
+        Fingerprint fp;
+        if (!(fin >> fp.count >> std::hex >> fp.lane[0] >> fp.lane[1]))
+            throw std::runtime_error("Cannot read the fingerprint: " + _filename);
+        return fp;
+    }
+
+    inline std::uint64_t size() const
+    { return count; }
+
+private:
+    static std::uint64_t hash(const std::uint8_t* _element, std::size_t _width, std::uint64_t _seed) {
+        std::uint64_t h = mix64(_seed ^ _width);
+        for (std::size_t off = 0; off < _width; off += sizeof(std::uint64_t)) {
+            std::uint64_t word = 0;
+            std::memcpy(&word, _element + off, std::min(sizeof(word), _width - off));
+            h = mix64(h ^ word);
+        }
+        return h;
+    }
+
+private:
+    std::uint64_t count = 0;
+    std::uint64_t lane[2] = {0, 0};
+};
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef FIT_HPP
+#define FIT_HPP
+
+#include <vector>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+// two-sided 95% Student t quantiles for 1..10 degrees of freedom, normal beyond
+inline double t_quantile_95(std::size_t _df) {
+    static constexpr double table[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228 };
+    if (_df == 0) return std::nan("");
+    return _df <= 10 ? table[_df - 1] : 1.960;
+}
+
+class Prediction { // point estimate and 95% prediction interval, multiplicative since the fit is in log space
+public:
+    double value = 0., low = 0., high = 0.;
+};
+
+class CostModel { // y = a * N^b * (ln N)^c, least squares on ln y = ln a + b ln N + c ln ln N
+public:
+    static constexpr std::size_t TERMS = 3;
+
+    CostModel(const std::vector<double>& _n, const std::vector<double>& _y) {
+        if (_n.size() != _y.size()) throw std::invalid_argument("Mismatched fit samples");
+        for (std::size_t i = 0; i < _n.size(); ++i)
+            if (_n[i] > 1. && _y[i] > 0.) { rows.push_back(features(_n[i])); logs.push_back(std::log(_y[i])); }
+        if (rows.size() < TERMS) throw std::invalid_argument("Too few sizes to fit a*N^b*log^c N");
+        solve();
+    }
+
+    inline double a() const { return std::exp(coef[0]); }
+    inline double b() const { return coef[1]; }
+    inline double c() const { return coef[2]; }
+    inline std::size_t points() const { return rows.size(); }
+
+    Prediction predict(double _n) const {
+        const auto x = features(_n);
+        double mean = 0.;
+        for (std::size_t j = 0; j < TERMS; ++j) mean += coef[j] * x[j];
+        Prediction p;
+        p.value = std::exp(mean);
+        const std::size_t df = rows.size() - TERMS;
+        if (df == 0) { p.low = p.high = std::nan(""); return p; } // exact fit, no residual to estimate the spread from
+        double leverage = 0.; // x^T (X^T X)^-1 x
+        for (std::size_t j = 0; j < TERMS; ++j)
+            for (std::size_t k = 0; k < TERMS; ++k) leverage += x[j] * inverse[j][k] * x[k];
+        const double se = std::sqrt(rss / df * (1. + leverage));
+        p.low  = std::exp(mean - t_quantile_95(df) * se);
+        p.high = std::exp(mean + t_quantile_95(df) * se);
+        return p;
+    }
+
+private:
+    using Row = std::array<double, TERMS>;
+
+    static Row features(double _n)
+    { return { 1., std::log(_n), std::log(std::log(_n)) }; }
+
+    // normal equations by Gauss-Jordan with partial pivoting, keeps (X^T X)^-1 for the interval
+    void solve() {
+        double m[TERMS][2 * TERMS] = {};
+        for (std::size_t i = 0; i < rows.size(); ++i)
+            for (std::size_t j = 0; j < TERMS; ++j)
+                for (std::size_t k = 0; k < TERMS; ++k) m[j][k] += rows[i][j] * rows[i][k];
+        for (std::size_t j = 0; j < TERMS; ++j) m[j][TERMS + j] = 1.;
+
+        for (std::size_t col = 0; col < TERMS; ++col) {
+            std::size_t pivot = col;
+            for (std::size_t r = col + 1; r < TERMS; ++r)
+                if (std::abs(m[r][col]) > std::abs(m[pivot][col])) pivot = r;
+            if (std::abs(m[pivot][col]) < 1e-12) throw std::runtime_error("Singular fit, sizes are not spread enough");
+            for (std::size_t k = 0; k < 2 * TERMS; ++k) std::swap(m[col][k], m[pivot][k]);
+            const double d = m[col][col];
+            for (std::size_t k = 0; k < 2 * TERMS; ++k) m[col][k] /= d;
+            for (std::size_t r = 0; r < TERMS; ++r) {
+                if (r == col) continue;
+                const double f = m[r][col];
+                for (std::size_t k = 0; k < 2 * TERMS; ++k) m[r][k] -= f * m[col][k];
+            }
+        }
+        for (std::size_t j = 0; j < TERMS; ++j)
+            for (std::size_t k = 0; k < TERMS; ++k) inverse[j][k] = m[j][TERMS + k];
+
+        coef.fill(0.);
+        for (std::size_t j = 0; j < TERMS; ++j)
+            for (std::size_t k = 0; k < TERMS; ++k)
+                for (std::size_t i = 0; i < rows.size(); ++i) coef[j] += inverse[j][k] * rows[i][k] * logs[i];
+
+        rss = 0.;
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            double fitted = 0.;
+            for (std::size_t j = 0; j < TERMS; ++j) fitted += coef[j] * rows[i][j];
+            rss += (logs[i] - fitted) * (logs[i] - fitted);
+        }
+    }
+
+private:
+    std::vector<Row> rows;
+    std::vector<double> logs;
+    Row coef;
+    double inverse[TERMS][TERMS];
+    double rss = 0.; // residual sum of squares in log space
+};
+
+#endif
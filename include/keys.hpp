@@ -0,0 +1,162 @@
+#ifndef KEYS_HPP
+#define KEYS_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <bit>
+#include <string>
+#include <type_traits>
+#include <stdexcept>
+
+// dataset filename prefix: int (unsigned, the original format), sint (two's complement), float (IEEE 754)
+enum class KeyKind { UNSIGNED, SIGNED, FLOAT };
+
+inline KeyKind parse_kind(const std::string& _prefix) {
+    if (_prefix == "int")   return KeyKind::UNSIGNED;
+    if (_prefix == "sint")  return KeyKind::SIGNED;
+    if (_prefix == "float") return KeyKind::FLOAT;
+    throw std::invalid_argument("Unsupported key type: " + _prefix);
+}
+
+inline std::string kind_prefix(KeyKind _kind) {
+    switch (_kind) {
+    case KeyKind::UNSIGNED: return "int";
+    case KeyKind::SIGNED:   return "sint";
+    case KeyKind::FLOAT:    return "float";
+    }
+    return "";
+}
+
+// fixed-size record ordered by its key prefix only, the payload travels with it
+template<class Key, std::size_t Payload>
+struct __attribute__((packed)) Record {
+    Key key;
+    std::uint8_t payload[Payload];
+};
+
+template<class Key, std::size_t Payload>
+inline bool operator< (const Record<Key, Payload>& _a, const Record<Key, Payload>& _b) { return _a.key <  _b.key; }
+template<class Key, std::size_t Payload>
+inline bool operator<=(const Record<Key, Payload>& _a, const Record<Key, Payload>& _b) { return _a.key <= _b.key; }
+template<class Key, std::size_t Payload>
+inline bool operator> (const Record<Key, Payload>& _a, const Record<Key, Payload>& _b) { return _a.key >  _b.key; }
+template<class Key, std::size_t Payload>
+inline bool operator>=(const Record<Key, Payload>& _a, const Record<Key, Payload>& _b) { return _a.key >= _b.key; }
+
+template<class T>
+inline T key_of(const T& _val) { return _val; }
+
+template<class Key, std::size_t Payload>
+inline Key key_of(const Record<Key, Payload>& _rec) { return _rec.key; }
+
+// original position stored by datagen in the first 8 payload bytes
+template<class Key, std::size_t Payload>
+inline std::uint64_t record_index(const Record<Key, Payload>& _rec) {
+    static_assert(Payload >= sizeof(std::uint64_t), "payload too small for an index");
+    std::uint64_t index;
+    std::memcpy(&index, _rec.payload, sizeof(index));
+    return index;
+}
+
+template<class T>
+using key_type_t = decltype(key_of(std::declval<T>()));
+
+template<class T>
+struct is_record : std::false_type {};
+
+template<class Key, std::size_t Payload>
+struct is_record<Record<Key, Payload>> : std::true_type {};
+
+template<class T>
+constexpr bool is_record_v = is_record<T>::value;
+
+// order-preserving unsigned image of a key, what the radix sorts take their digits from
+template<class T> requires std::is_unsigned_v<T>
+inline T radix_key(T _val) { return _val; }
+
+template<class T> requires (std::is_integral_v<T> && std::is_signed_v<T>)
+inline std::make_unsigned_t<T> radix_key(T _val) {
+    using U = std::make_unsigned_t<T>;
+    return static_cast<U>(_val) ^ (U(1) << (sizeof(T) * 8 - 1)); // flip the sign bit
+}
+
+inline std::uint32_t radix_key(float _val) {
+    std::uint32_t u = std::bit_cast<std::uint32_t>(_val);
+    return (u >> 31) ? ~u : u | 0x80000000u; // negatives reverse their order, positives move above them
+}
+
+inline std::uint64_t radix_key(double _val) {
+    std::uint64_t u = std::bit_cast<std::uint64_t>(_val);
+    return (u >> 63) ? ~u : u | 0x8000000000000000ull;
+}
+
+template<class Key, std::size_t Payload>
+inline auto radix_key(const Record<Key, Payload>& _rec) { return radix_key(Key(_rec.key)); }
+
+template<class T>
+using radix_t = decltype(radix_key(std::declval<T>()));
+
+template<class T>
+struct TypeTag { using type = T; };
+
+constexpr std::size_t RECORD_PAYLOAD = 8; // bytes after the key in pN datasets
+
+// calls _f(TypeTag<T>{}) with the element type of a dataset, records exist for 32/64-bit keys only;
+// the wider 32/128-byte payloads only measure layout, so they are built for unsigned keys alone
+template<class F>
+void visit_key_type(KeyKind _kind, std::int16_t _bits, std::size_t _payload, F&& _f) {
+    if (_payload == 0) {
+        switch (_kind) {
+        case KeyKind::UNSIGNED:
+            switch (_bits) {
+            case 8:  return _f(TypeTag<std::uint8_t >{});
+            case 16: return _f(TypeTag<std::uint16_t>{});
+            case 32: return _f(TypeTag<std::uint32_t>{});
+            case 64: return _f(TypeTag<std::uint64_t>{});
+            }
+            break;
+        case KeyKind::SIGNED:
+            switch (_bits) {
+            case 8:  return _f(TypeTag<std::int8_t >{});
+            case 16: return _f(TypeTag<std::int16_t>{});
+            case 32: return _f(TypeTag<std::int32_t>{});
+            case 64: return _f(TypeTag<std::int64_t>{});
+            }
+            break;
+        case KeyKind::FLOAT:
+            switch (_bits) {
+            case 32: return _f(TypeTag<float >{});
+            case 64: return _f(TypeTag<double>{});
+            }
+            break;
+        }
+    } else if (_payload == RECORD_PAYLOAD) {
+        switch (_kind) {
+        case KeyKind::UNSIGNED:
+            if (_bits == 32) return _f(TypeTag<Record<std::uint32_t, RECORD_PAYLOAD>>{});
+            if (_bits == 64) return _f(TypeTag<Record<std::uint64_t, RECORD_PAYLOAD>>{});
+            break;
+        case KeyKind::SIGNED:
+            if (_bits == 32) return _f(TypeTag<Record<std::int32_t, RECORD_PAYLOAD>>{});
+            if (_bits == 64) return _f(TypeTag<Record<std::int64_t, RECORD_PAYLOAD>>{});
+            break;
+        case KeyKind::FLOAT:
+            if (_bits == 32) return _f(TypeTag<Record<float,  RECORD_PAYLOAD>>{});
+            if (_bits == 64) return _f(TypeTag<Record<double, RECORD_PAYLOAD>>{});
+            break;
+        }
+    } else if (_kind == KeyKind::UNSIGNED && (_bits == 32 || _bits == 64)) {
+        switch (_payload) {
+        case 32:
+            if (_bits == 32) return _f(TypeTag<Record<std::uint32_t, 32>>{});
+            return _f(TypeTag<Record<std::uint64_t, 32>>{});
+        case 128:
+            if (_bits == 32) return _f(TypeTag<Record<std::uint32_t, 128>>{});
+            return _f(TypeTag<Record<std::uint64_t, 128>>{});
+        }
+    }
+    throw std::invalid_argument("Unsupported element type: " + kind_prefix(_kind) + std::to_string(_bits) +
+                                (_payload ? "p" + std::to_string(_payload) : std::string()));
+}
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef NETWORK_HPP
+#define NETWORK_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <type_traits>
+#include <algorithm>
+
+// bitonic sorting networks for blocks of at most NETWORK_MAX bare keys: the block is padded to a power of two
+// with the largest key, loaded into vector registers and sorted by a fixed sequence of lane shuffles and min/max.
+// The kernels are compiled for AVX2 and SSE4.2 through GCC vector extensions and picked once via CPUID;
+// elsewhere, and on every architecture but x86, the same network runs on scalars
+constexpr std::size_t NETWORK_MIN = 8;
+constexpr std::size_t NETWORK_MAX = 64;
+
+enum class NetworkIsa { SCALAR, SSE4, AVX2 };
+
+#if defined(__x86_64__) || defined(__i386__)
+#define NETWORK_X86
+#endif
+
+inline NetworkIsa network_isa() {
+#ifdef NETWORK_X86
+    static const NetworkIsa isa = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return NetworkIsa::AVX2;
+        if (__builtin_cpu_supports("sse4.2")) return NetworkIsa::SSE4; // pcmpgtq for 64-bit keys
+        return NetworkIsa::SCALAR;
+    }();
+    return isa;
+#else
+    return NetworkIsa::SCALAR;
+#endif
+}
+
+inline const char* network_isa_name(NetworkIsa _isa) {
+    switch (_isa) {
+    case NetworkIsa::AVX2: return "avx2";
+    case NetworkIsa::SSE4: return "sse4.2";
+    default:               return "scalar";
+    }
+}
+
+template<class T>
+constexpr bool network_key_v = std::is_arithmetic_v<T>; // records are left to the callers' insertion sorts
+
+// compare-exchanges of the bitonic network on _m (a power of two) keys
+constexpr std::size_t network_comparators(std::size_t _m) {
+    std::size_t steps = 0;
+    for (std::size_t k = 2; k <= _m; k *= 2)
+        for (std::size_t j = k; j > 1; j /= 2) ++steps;
+    return steps * _m / 2;
+}
+
+namespace network_detail {
+
+template<class T>
+constexpr T pad() {
+    if constexpr (std::is_floating_point_v<T>) return std::numeric_limits<T>::infinity();
+    else return std::numeric_limits<T>::max();
+}
+
+constexpr std::size_t highbit(std::size_t _x) {
+    std::size_t b = 1;
+    while (b * 2 <= _x) b *= 2;
+    return b;
+}
+
+#ifdef NETWORK_X86
+// shuffle indices are integers as wide as the keys
+template<std::size_t Width> struct Index;
+template<> struct Index<1> { using type = std::int8_t; };
+template<> struct Index<2> { using type = std::int16_t; };
+template<> struct Index<4> { using type = std::int32_t; };
+template<> struct Index<8> { using type = std::int64_t; };
+
+template<class T, std::size_t Bytes>
+struct Vec {
+    static constexpr std::size_t lanes = Bytes / sizeof(T);
+    typedef T type __attribute__((vector_size(Bytes)));
+    typedef typename Index<sizeof(T)>::type mask __attribute__((vector_size(Bytes)));
+};
+
+// one step of the network: key e meets key e ^ X, the one of the pair without the top bit of X takes the minimum.
+// X = k - 1 opens the merge of two sorted halves of k keys, X = k / 4 ... 1 finish it
+template<class T, std::size_t Bytes, std::size_t R, std::size_t X, std::size_t... I>
+[[gnu::always_inline]] inline void step(typename Vec<T, Bytes>::type (&v)[R], std::index_sequence<I...>) {
+    using V = typename Vec<T, Bytes>::type;
+    using M = typename Vec<T, Bytes>::mask;
+    using E = typename Index<sizeof(T)>::type;
+    constexpr std::size_t L = Vec<T, Bytes>::lanes;
+    constexpr std::size_t bit = highbit(X);
+    if constexpr (X < L) { // pairs within a register: shuffle to the partner, then pick min or max per lane
+        const M partner = { E(I ^ X)... };
+        const M pick = { E(I & bit ? I + L : I)... };
+        for (std::size_t r = 0; r < R; ++r) {
+            V p = __builtin_shuffle(v[r], partner);
+            V lo = v[r] < p ? v[r] : p;
+            V hi = v[r] < p ? p : v[r];
+            v[r] = __builtin_shuffle(lo, hi, pick);
+        }
+    } else { // pairs across registers, lanes reversed when the step opens a merge
+        const M flip = { E(I ^ (X % L))... };
+        for (std::size_t r = 0; r < R; ++r) {
+            if (r & (bit / L)) continue;
+            const std::size_t q = r ^ (X / L);
+            V b = X % L ? __builtin_shuffle(v[q], flip) : v[q];
+            V lo = v[r] < b ? v[r] : b;
+            V hi = v[r] < b ? b : v[r];
+            v[r] = lo;
+            v[q] = X % L ? __builtin_shuffle(hi, flip) : hi;
+        }
+    }
+}
+
+template<class T, std::size_t Bytes, std::size_t R, std::size_t K>
+[[gnu::always_inline]] inline void merge(typename Vec<T, Bytes>::type (&v)[R]) {
+    constexpr auto lanes = std::make_index_sequence<Vec<T, Bytes>::lanes>();
+    step<T, Bytes, R, K - 1>(v, lanes);
+    [&]<std::size_t... J>(std::index_sequence<J...>) {
+        (step<T, Bytes, R, (K / 4 >> J)>(v, lanes), ...);
+    }(std::make_index_sequence<std::size_t(__builtin_ctzll(K)) - 1>());
+    if constexpr (2 * K <= R * Vec<T, Bytes>::lanes) merge<T, Bytes, R, 2 * K>(v);
+}
+
+// sorts the M keys at _block, M at least one register wide
+template<class T, std::size_t Bytes, std::size_t M>
+[[gnu::always_inline]] inline void kernel(T* _block) {
+    constexpr std::size_t R = M / Vec<T, Bytes>::lanes;
+    typename Vec<T, Bytes>::type v[R];
+    std::memcpy(v, _block, sizeof(v));
+    merge<T, Bytes, R, 2>(v);
+    std::memcpy(_block, v, sizeof(v));
+}
+
+template<class T, std::size_t M>
+__attribute__((target("avx2"))) void sort_avx2(T* _block)
+{ kernel<T, 32, M>(_block); }
+
+template<class T, std::size_t M>
+__attribute__((target("sse4.2"))) void sort_sse4(T* _block)
+{ kernel<T, 16, M>(_block); }
+
+#endif
+
+template<class T>
+void sort_scalar(T* _block, std::size_t _m) {
+    auto exchange = [&](std::size_t _e, std::size_t _p) {
+        T lo = std::min(_block[_e], _block[_p]), hi = std::max(_block[_e], _block[_p]);
+        _block[_e] = lo; _block[_p] = hi;
+    };
+    for (std::size_t k = 2; k <= _m; k *= 2) {
+        for (std::size_t e = 0; e < _m; ++e)
+            if ((e ^ (k - 1)) > e) exchange(e, e ^ (k - 1));
+        for (std::size_t j = k / 4; j > 0; j /= 2)
+            for (std::size_t e = 0; e < _m; ++e)
+                if ((e ^ j) > e) exchange(e, e ^ j);
+    }
+}
+
+#ifdef NETWORK_X86
+// network_block() never picks a block narrower than a register, the other branches are not instantiated
+template<class T, std::size_t M>
+inline void sort_vector(T* _block, NetworkIsa _isa) {
+    if (_isa == NetworkIsa::AVX2) {
+        if constexpr (M * sizeof(T) >= 32) sort_avx2<T, M>(_block);
+    }
+    else if constexpr (M * sizeof(T) >= 16) sort_sse4<T, M>(_block);
+}
+#endif
+
+} // namespace network_detail
+
+// block size the network sorts _n keys in, a power of two from NETWORK_MIN and at least one register of the ISA
+template<class T>
+inline std::size_t network_block(std::size_t _n, NetworkIsa _isa = network_isa()) {
+    std::size_t m = NETWORK_MIN;
+    while (m < _n) m *= 2;
+    const std::size_t bytes = _isa == NetworkIsa::AVX2 ? 32 : _isa == NetworkIsa::SSE4 ? 16 : 0;
+    while (m * sizeof(T) < bytes) m *= 2;
+    return m;
+}
+
+// sorts the _n <= NETWORK_MAX keys at _data in place, returns the padded block size the network ran on
+template<class T>
+std::size_t network_sort(T* _data, std::size_t _n, NetworkIsa _isa = network_isa()) {
+    static_assert(network_key_v<T>, "sorting networks take bare keys only");
+    using namespace network_detail;
+    alignas(64) T block[NETWORK_MAX];
+    const std::size_t m = network_block<T>(_n, _isa);
+    std::copy(_data, _data + _n, block);
+    std::fill(block + _n, block + m, pad<T>());
+#ifdef NETWORK_X86
+    if (_isa == NetworkIsa::SCALAR) sort_scalar(block, m);
+    else switch (m) {
+    case 8:  sort_vector<T, 8 >(block, _isa); break;
+    case 16: sort_vector<T, 16>(block, _isa); break;
+    case 32: sort_vector<T, 32>(block, _isa); break;
+    case 64: sort_vector<T, 64>(block, _isa); break;
+    }
+#else
+    sort_scalar(block, m);
+#endif
+    std::copy(block, block + _n, _data);
+    return m;
+}
+
+#endif
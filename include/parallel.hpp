@@ -0,0 +1,204 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+class ThreadPool { // fixed set of workers draining a shared FIFO, tasks learn which worker runs them
+public:
+    using Task = std::function<void(std::size_t)>;
+
+    ThreadPool(std::size_t _threads) {
+        if (_threads == 0) _threads = 1;
+        for (std::size_t w = 0; w < _threads; ++w)
+            workers.emplace_back([this, w]() { this->work(w); });
+    }
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv_task.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(Task _task) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            tasks.push_back(std::move(_task));
+            ++pending;
+        }
+        cv_task.notify_one();
+    }
+
+    // blocks until every submitted task has finished, rethrows the first failure
+    void wait() {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv_done.wait(lock, [this]() { return pending == 0; });
+        if (failure) {
+            std::exception_ptr e = failure;
+            failure = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+    inline std::size_t size() const
+    { return workers.size(); }
+
+private:
+    void work(std::size_t _worker) {
+        while (true) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv_task.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if (tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            try { task(_worker); }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (!failure) failure = std::current_exception();
+            }
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (--pending == 0) cv_done.notify_all();
+            }
+        }
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<Task> tasks;
+    std::mutex mtx;
+    std::condition_variable cv_task;
+    std::condition_variable cv_done;
+    std::size_t pending = 0;
+    bool stopping = false;
+    std::exception_ptr failure;
+};
+
+class WorkStealingPool { // per-worker deques, owners work LIFO at the back, idle workers steal FIFO from the front
+public:
+    using Task = std::function<void(std::size_t)>;
+
+    WorkStealingPool(std::size_t _threads) {
+        if (_threads == 0) _threads = 1;
+        for (std::size_t w = 0; w < _threads; ++w)
+            queues.push_back(std::make_unique<Queue>());
+        for (std::size_t w = 0; w < _threads; ++w)
+            workers.emplace_back([this, w]() { this->work(w); });
+    }
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(idle_mtx);
+            stopping = true;
+        }
+        cv_task.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // pushes onto the deque of _worker, tasks call this with their own worker index
+    void spawn(Task _task, std::size_t _worker = 0) {
+        ++pending;
+        {
+            std::lock_guard<std::mutex> lock(queues[_worker]->mtx);
+            queues[_worker]->tasks.push_back(std::move(_task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(idle_mtx);
+            ++queued;
+        }
+        cv_task.notify_one();
+    }
+
+    // blocks until every task, including the ones spawned by tasks, has finished
+    void wait() {
+        std::unique_lock<std::mutex> lock(idle_mtx);
+        cv_done.wait(lock, [this]() { return pending == 0; });
+        if (failure) {
+            std::exception_ptr e = failure;
+            failure = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+    inline std::size_t size() const
+    { return workers.size(); }
+
+private:
+    struct Queue {
+        std::mutex mtx;
+        std::deque<Task> tasks;
+    };
+
+    bool take(std::size_t _worker, Task& _task) {
+        for (std::size_t k = 0; k < queues.size(); ++k) {
+            Queue& q = *queues[(_worker + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(q.mtx);
+            if (q.tasks.empty()) continue;
+            if (k == 0) { _task = std::move(q.tasks.back());  q.tasks.pop_back();  }
+            else        { _task = std::move(q.tasks.front()); q.tasks.pop_front(); }
+            return true;
+        }
+        return false;
+    }
+
+    void work(std::size_t _worker) {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(idle_mtx);
+                cv_task.wait(lock, [this]() { return stopping || queued > 0; });
+                if (queued == 0) return;
+                --queued;
+            }
+            Task task;
+            while (!take(_worker, task)); // the reservation guarantees some deque still holds a task for us
+            try { task(_worker); }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(idle_mtx);
+                if (!failure) failure = std::current_exception();
+            }
+            if (--pending == 0) {
+                std::lock_guard<std::mutex> lock(idle_mtx);
+                cv_done.notify_all();
+            }
+        }
+    }
+
+private:
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex idle_mtx;
+    std::condition_variable cv_task;
+    std::condition_variable cv_done;
+    std::size_t queued = 0; // tasks sitting in deques and not yet claimed, guarded by idle_mtx
+    std::atomic<std::size_t> pending = 0; // tasks spawned and not yet finished
+    bool stopping = false;
+    std::exception_ptr failure;
+};
+
+// runs body(part, worker) for part in [0, parts) on the pool and waits for all of them
+template<class Body>
+void parallel_for(ThreadPool& pool, std::size_t parts, Body body) {
+    for (std::size_t part = 0; part < parts; ++part)
+        pool.submit([&body, part](std::size_t worker) { body(part, worker); });
+    pool.wait();
+}
+
+#endif
@@ -0,0 +1,213 @@
+#ifndef PARTITION_HPP
+#define PARTITION_HPP
+
+#include <cstdint>
+#include <array>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PARTITION_X86
+#include <immintrin.h>
+#endif
+
+// in-place quicksort partition of unsigned 32/64-bit keys, one vector of keys per step: every vector is split into
+// the keys going left and right, by AVX-512 compress-stores or by an AVX2 permutation looked up from the comparison
+// mask, and written to both ends of the range. The kernels are picked once via CPUID; other ISAs, other
+// architectures than x86 and other key types take the scalar two-pointer partition with the same result contract
+enum class PartitionIsa { SCALAR, AVX2, AVX512 };
+
+inline PartitionIsa partition_isa() {
+#ifdef PARTITION_X86
+    static const PartitionIsa isa = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return PartitionIsa::AVX512;
+        if (__builtin_cpu_supports("avx2")) return PartitionIsa::AVX2;
+        return PartitionIsa::SCALAR;
+    }();
+    return isa;
+#else
+    return PartitionIsa::SCALAR;
+#endif
+}
+
+inline const char* partition_isa_name(PartitionIsa _isa) {
+    switch (_isa) {
+    case PartitionIsa::AVX512: return "avx512f";
+    case PartitionIsa::AVX2:   return "avx2";
+    default:                   return "scalar";
+    }
+}
+
+template<class T>
+constexpr bool vector_partition_v = std::is_same_v<T, std::uint32_t> || std::is_same_v<T, std::uint64_t>;
+
+namespace partition_detail {
+
+// Strict: keys below the pivot go left, otherwise keys not above it
+template<bool Strict, class T>
+inline bool goes_left(const T& _x, const T& _pivot)
+{ if constexpr (Strict) return _x < _pivot; else return _x <= _pivot; }
+
+template<bool Strict, class T>
+std::size_t scalar(T* _a, std::size_t _n, const T& _pivot) {
+    std::size_t i = 0, j = _n;
+    while (true) {
+        while (i < j && goes_left<Strict>(_a[i], _pivot)) ++i;
+        while (i < j && !goes_left<Strict>(_a[j - 1], _pivot)) --j;
+        if (i >= j) return i;
+        std::swap(_a[i++], _a[--j]);
+    }
+}
+
+#ifdef PARTITION_X86
+// permutation moving the lanes clear in the mask to the front and the set ones to the back, both in order;
+// Split 32-bit indices per lane, so 64-bit lanes are permuted as pairs of 32-bit halves
+template<std::size_t Lanes, std::size_t Split>
+constexpr std::array<std::array<std::uint32_t, Lanes * Split>, (1 << Lanes)> make_table() {
+    std::array<std::array<std::uint32_t, Lanes * Split>, (1 << Lanes)> table = {};
+    for (std::size_t mask = 0; mask < table.size(); ++mask) {
+        std::size_t out = 0;
+        for (int right = 0; right < 2; ++right)
+            for (std::size_t lane = 0; lane < Lanes; ++lane)
+                if (bool(mask >> lane & 1) == bool(right))
+                    for (std::size_t s = 0; s < Split; ++s, ++out) table[mask][out] = std::uint32_t(lane * Split + s);
+    }
+    return table;
+}
+
+// split(): partitions the W keys at _src, left keys are written from _left on, right keys end right before _right;
+// returns the number of left keys. The AVX2 variants store whole vectors at both ends, so W slots must be free there
+template<class T> struct Avx2;
+template<class T> struct Avx512;
+
+template<>
+struct Avx2<std::uint32_t> {
+    static constexpr std::size_t W = 8;
+    alignas(32) static constexpr auto table = make_table<8, 1>();
+
+    template<bool Strict>
+    __attribute__((target("avx2"))) static inline std::size_t
+    split(const std::uint32_t* _src, std::uint32_t _pivot, std::uint32_t* _left, std::uint32_t* _right) {
+        const __m256i sign = _mm256_set1_epi32(INT32_MIN); // unsigned order through the signed compare
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_src));
+        const __m256i x = _mm256_xor_si256(v, sign), p = _mm256_xor_si256(_mm256_set1_epi32(_pivot), sign);
+        const unsigned right = Strict ? ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(p, x))) & 0xFF
+                                      :  _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(x, p)));
+        const __m256i perm = _mm256_load_si256(reinterpret_cast<const __m256i*>(table[right].data()));
+        const __m256i packed = _mm256_permutevar8x32_epi32(v, perm);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(_left), packed);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(_right - W), packed);
+        return W - __builtin_popcount(right);
+    }
+};
+
+template<>
+struct Avx2<std::uint64_t> {
+    static constexpr std::size_t W = 4;
+    alignas(32) static constexpr auto table = make_table<4, 2>();
+
+    template<bool Strict>
+    __attribute__((target("avx2"))) static inline std::size_t
+    split(const std::uint64_t* _src, std::uint64_t _pivot, std::uint64_t* _left, std::uint64_t* _right) {
+        const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_src));
+        const __m256i x = _mm256_xor_si256(v, sign), p = _mm256_xor_si256(_mm256_set1_epi64x(_pivot), sign);
+        const unsigned right = Strict ? ~_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(p, x))) & 0xF
+                                      :  _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(x, p)));
+        const __m256i perm = _mm256_load_si256(reinterpret_cast<const __m256i*>(table[right].data()));
+        const __m256i packed = _mm256_permutevar8x32_epi32(v, perm);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(_left), packed);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(_right - W), packed);
+        return W - __builtin_popcount(right);
+    }
+};
+
+template<>
+struct Avx512<std::uint32_t> {
+    static constexpr std::size_t W = 16;
+
+    template<bool Strict>
+    __attribute__((target("avx512f"))) static inline std::size_t
+    split(const std::uint32_t* _src, std::uint32_t _pivot, std::uint32_t* _left, std::uint32_t* _right) {
+        const __m512i v = _mm512_loadu_si512(_src), p = _mm512_set1_epi32(_pivot);
+        const __mmask16 right = Strict ? _mm512_cmpge_epu32_mask(v, p) : _mm512_cmpgt_epu32_mask(v, p);
+        const std::size_t count = __builtin_popcount(right);
+        _mm512_mask_compressstoreu_epi32(_left, __mmask16(~right), v);
+        _mm512_mask_compressstoreu_epi32(_right - count, right, v);
+        return W - count;
+    }
+};
+
+template<>
+struct Avx512<std::uint64_t> {
+    static constexpr std::size_t W = 8;
+
+    template<bool Strict>
+    __attribute__((target("avx512f"))) static inline std::size_t
+    split(const std::uint64_t* _src, std::uint64_t _pivot, std::uint64_t* _left, std::uint64_t* _right) {
+        const __m512i v = _mm512_loadu_si512(_src), p = _mm512_set1_epi64(_pivot);
+        const __mmask8 right = Strict ? _mm512_cmpge_epu64_mask(v, p) : _mm512_cmpgt_epu64_mask(v, p);
+        const std::size_t count = __builtin_popcount(right);
+        _mm512_mask_compressstoreu_epi64(_left, __mmask8(~right), v);
+        _mm512_mask_compressstoreu_epi64(_right - count, right, v);
+        return W - count;
+    }
+};
+
+// the first and last W keys are set aside, which leaves 2W free slots between the write and read fronts; reading
+// from the side with less free space keeps at least W free on both sides for the next split
+template<class Ops, bool Strict, class T>
+std::size_t vectorized(T* _a, std::size_t _n, T _pivot) {
+    constexpr std::size_t W = Ops::W;
+    if (_n < 2 * W) return scalar<Strict>(_a, _n, _pivot);
+    T rest[3 * W]; // set-aside keys and the tail shorter than a vector
+    std::copy(_a, _a + W, rest);
+    std::copy(_a + _n - W, _a + _n, rest + W);
+    std::size_t read_l = W, read_r = _n - W;  // unread [read_l, read_r)
+    std::size_t write_l = 0, write_r = _n;    // done [0, write_l) and [write_r, _n)
+    while (read_r - read_l >= W) {
+        const T* src;
+        if (read_l - write_l <= write_r - read_r) { src = _a + read_l; read_l += W; }
+        else { read_r -= W; src = _a + read_r; }
+        const std::size_t left = Ops::template split<Strict>(src, _pivot, _a + write_l, _a + write_r);
+        write_l += left;
+        write_r -= W - left;
+    }
+    const std::size_t tail = read_r - read_l;
+    std::copy(_a + read_l, _a + read_r, rest + 2 * W);
+    for (std::size_t i = 0; i < 2 * W + tail; ++i) { // exactly fills [write_l, write_r)
+        if (goes_left<Strict>(rest[i], _pivot)) _a[write_l++] = rest[i];
+        else _a[--write_r] = rest[i];
+    }
+    return write_l;
+}
+
+// flatten inlines the driver and its kernels into one function compiled for the target
+template<bool Strict, class T>
+__attribute__((target("avx2"), flatten)) std::size_t partition_avx2(T* _a, std::size_t _n, T _pivot)
+{ return vectorized<Avx2<T>, Strict>(_a, _n, _pivot); }
+
+template<bool Strict, class T>
+__attribute__((target("avx512f"), flatten)) std::size_t partition_avx512(T* _a, std::size_t _n, T _pivot)
+{ return vectorized<Avx512<T>, Strict>(_a, _n, _pivot); }
+
+#endif
+
+} // namespace partition_detail
+
+// rearranges the _n keys at _a so that those going left (below _pivot if Strict, else not above it) come first;
+// returns their number
+template<bool Strict, class T>
+std::size_t partition_keys(T* _a, std::size_t _n, const T& _pivot, [[maybe_unused]] PartitionIsa _isa = partition_isa()) {
+    using namespace partition_detail;
+#ifdef PARTITION_X86
+    if constexpr (vector_partition_v<T>) {
+        if (_isa == PartitionIsa::AVX512) return partition_avx512<Strict>(_a, _n, _pivot);
+        if (_isa == PartitionIsa::AVX2) return partition_avx2<Strict>(_a, _n, _pivot);
+    }
+#endif
+    return scalar<Strict>(_a, _n, _pivot);
+}
+
+#endif
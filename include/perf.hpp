@@ -0,0 +1,118 @@
+#ifndef PERF_HPP
+#define PERF_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <array>
+#include <filesystem>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+enum PerfEvent { PERF_CYCLES = 0, PERF_INSTRUCTIONS, PERF_CACHE_MISSES, PERF_BRANCH_MISSES, PERF_EVENTS };
+
+class PerfSample { // one reading of the hardware counters, -1 marks a counter the kernel refused
+public:
+    PerfSample() { values.fill(-1); }
+
+    inline std::int64_t operator[](PerfEvent _event) const
+    { return values[_event]; }
+
+    inline bool available(PerfEvent _event) const
+    { return values[_event] >= 0; }
+
+public:
+    std::array<std::int64_t, PERF_EVENTS> values;
+};
+
+class PerfGroup { // perf_event_open counter groups over every thread of the process, user space only
+public:
+    // _all_threads: false when other threads of the process run unrelated work (scheduler jobs)
+    PerfGroup(bool _all_threads = true) {
+        // threads already alive (worker pools built with the sorter) get their own group,
+        // threads spawned while counting are picked up through inherit
+        std::error_code ec;
+        if (_all_threads)
+            for (const auto& task : std::filesystem::directory_iterator("/proc/self/task", ec))
+                open_group(std::stoi(task.path().filename().string()));
+        if (groups.empty()) open_group(0);
+    }
+    ~PerfGroup() {
+        for (auto& group : groups)
+            for (int fd : group) if (fd >= 0) close(fd);
+    }
+
+    PerfGroup(const PerfGroup&) = delete;
+    PerfGroup& operator=(const PerfGroup&) = delete;
+
+    inline bool available() const
+    { return !groups.empty() && groups.front()[PERF_CYCLES] >= 0; }
+
+    void start() {
+        for (auto& group : groups) {
+            ioctl(group.front(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(group.front(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+    }
+
+    PerfSample stop() {
+        for (auto& group : groups)
+            ioctl(group.front(), PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        PerfSample sample;
+        if (!available()) return sample;
+        for (std::size_t e = 0; e < PERF_EVENTS; ++e) {
+            if (groups.front()[e] < 0) continue;
+            double total = 0.;
+            for (auto& group : groups) total += read_scaled(group[e]);
+            sample.values[e] = std::int64_t(total);
+        }
+        return sample;
+    }
+
+private:
+    using Group = std::array<int, PERF_EVENTS>;
+
+    void open_group(pid_t _tid) {
+        static constexpr std::uint64_t config[PERF_EVENTS] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+        };
+        Group group;
+        group.fill(-1);
+        for (std::size_t e = 0; e < PERF_EVENTS; ++e) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = config[e];
+            attr.disabled = (e == 0); // members follow the leader
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            group[e] = syscall(SYS_perf_event_open, &attr, _tid, -1, e == 0 ? -1 : group[0], 0);
+            if (group[0] < 0) return; // no leader, counters are not permitted here
+        }
+        // a missing member is dropped for every thread so the columns stay comparable
+        if (!groups.empty())
+            for (std::size_t e = 0; e < PERF_EVENTS; ++e)
+                if (groups.front()[e] < 0 && group[e] >= 0) { close(group[e]); group[e] = -1; }
+        groups.push_back(group);
+    }
+
+    // extrapolates when the kernel had to multiplex the PMU between groups
+    static double read_scaled(int _fd) {
+        if (_fd < 0) return 0.;
+        std::uint64_t buf[3] = {0, 0, 0}; // value, time_enabled, time_running
+        if (::read(_fd, buf, sizeof(buf)) != sizeof(buf) || buf[2] == 0) return 0.;
+        return double(buf[0]) * double(buf[1]) / double(buf[2]);
+    }
+
+private:
+    std::vector<Group> groups;
+};
+
+#endif
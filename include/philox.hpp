@@ -0,0 +1,62 @@
+#ifndef PHILOX_HPP
+#define PHILOX_HPP
+
+#include <cstdint>
+#include <array>
+#include <limits>
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3"), a counter-based generator:
+// the output is a pure function of (key, counter), so any stream can be entered without replaying the others
+class Philox4x32 {
+public:
+    using result_type = std::uint32_t;
+
+    // _seed keys the generator, _stream selects an independent sequence (e.g. a block index)
+    Philox4x32(std::uint64_t _seed, std::uint64_t _stream = 0)
+        : key{ std::uint32_t(_seed), std::uint32_t(_seed >> 32) },
+          stream(_stream) {}
+
+    static constexpr result_type min()
+    { return 0; }
+
+    static constexpr result_type max()
+    { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        if (pos == out.size()) {
+            out = block(counter++);
+            pos = 0;
+        }
+        return out[pos++];
+    }
+
+private:
+    using Word4 = std::array<std::uint32_t, 4>;
+
+    static constexpr std::uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57; // round multipliers
+    static constexpr std::uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85; // Weyl key increments
+    static constexpr int ROUNDS = 10;
+
+    // counter words: [0, 1] position within the stream, [2, 3] the stream itself
+    Word4 block(std::uint64_t _counter) const {
+        Word4 c = { std::uint32_t(_counter), std::uint32_t(_counter >> 32), std::uint32_t(stream), std::uint32_t(stream >> 32) };
+        std::uint32_t k0 = key[0], k1 = key[1];
+        for (int r = 0; r < ROUNDS; ++r) {
+            const std::uint64_t p0 = std::uint64_t(M0) * c[0];
+            const std::uint64_t p1 = std::uint64_t(M1) * c[2];
+            c = { std::uint32_t(p1 >> 32) ^ c[1] ^ k0, std::uint32_t(p1),
+                  std::uint32_t(p0 >> 32) ^ c[3] ^ k1, std::uint32_t(p0) };
+            k0 += W0; k1 += W1;
+        }
+        return c;
+    }
+
+private:
+    const std::array<std::uint32_t, 2> key;
+    const std::uint64_t stream;
+    std::uint64_t counter = 0;
+    Word4 out = {};
+    std::size_t pos = 4; // out is empty until the first draw
+};
+
+#endif
@@ -3,9 +3,14 @@
 
 #include <algorithm> // std::swap
 #include <utility> // std::pair
+#include <string>
+#include <vector>
+#include <random>
 
 #include "sortbase.hpp"
 #include "filesys.hpp"
+#include "parallel.hpp"
+#include "partition.hpp"
 
 #define UNUSED(X) (void)(X)
 
@@ -18,6 +23,7 @@ public:
         bool swapped = true;
         std::size_t i, N = size<IntType>();
         while (swapped) {
+            poll();
             swapped = false;
             for (i = 0; i < N - 1; ++i) {
                 if (!lte<IntType>(i, i + 1)) {
@@ -30,12 +36,7 @@ public:
     }
 
     void run(void) {
-        switch (mnt.meta.bsize) {
-        case 8:  run_<std::uint8_t >(); break;
-        case 16: run_<std::uint16_t>(); break;
-        case 32: run_<std::uint32_t>(); break;
-        case 64: run_<std::uint64_t>(); break;
-        }
+        dispatch(this);
     }
 };
 
@@ -48,6 +49,7 @@ public:
         IntType min, arr_j;
         std::size_t i, j, min_index;
         for (i = 0; i < mnt.meta.size; ++i) {
+            poll();
             min = at<IntType>(i);
             min_index = i;
             for (j = i + 1; j < mnt.meta.size; ++j) {
@@ -62,12 +64,7 @@ public:
     }
 
     void run(void) {
-        switch (mnt.meta.bsize) {
-        case 8:  run_<std::uint8_t >(); break;
-        case 16: run_<std::uint16_t>(); break;
-        case 32: run_<std::uint32_t>(); break;
-        case 64: run_<std::uint64_t>(); break;
-        }
+        dispatch(this);
     }
 };
 
@@ -79,18 +76,14 @@ public:
     void run_(void) {
         std::size_t i, j;
         for (i = 1; i < mnt.meta.size; ++i) {
+            poll();
             for (j = i; j > 0 && lte<IntType>(j, j-1); --j)
                 swap<IntType>(j, j-1);
         }
     }
 
     void run(void) {
-        switch (mnt.meta.bsize) {
-        case 8:  run_<std::uint8_t >(); break;
-        case 16: run_<std::uint16_t>(); break;
-        case 32: run_<std::uint32_t>(); break;
-        case 64: run_<std::uint64_t>(); break;
-        }
+        dispatch(this);
     }
 };
 
@@ -106,6 +99,7 @@ public:
         // N1
         s = false; // copying direction
         while (true) {
+            poll(); // once per pass
             // N2
             if (!s) i = 0, j = N-1, k = N, l = 2*N - 1;
             else    k = 0, l = N-1, i = N, j = 2*N - 1;
@@ -163,12 +157,7 @@ public:
     }
 
     void run(void) {
-        switch (mnt.meta.bsize) {
-        case 8:  run_<std::uint8_t >(); break;
-        case 16: run_<std::uint16_t>(); break;
-        case 32: run_<std::uint32_t>(); break;
-        case 64: run_<std::uint64_t>(); break;
-        }
+        dispatch(this);
     }
 };
 
@@ -222,8 +211,10 @@ public:
 
     template<class IntType>
     void SetHeap() {
-        for (std::size_t j = 1; j < n; ++j)
+        for (std::size_t j = 1; j < n; ++j) {
+            poll();
             InHeap<IntType>(j, at<IntType>(j));
+        }
     }
 
     template<class IntType>
@@ -232,6 +223,7 @@ public:
         n = size<IntType>();
         SetHeap<IntType>(); // in-place rearrangement
         for (std::size_t i = n - 1; i > 0; --i) {
+            poll();
             OutHeap<IntType>(out);
             set_val<IntType>(i, out);
             --n;
@@ -239,12 +231,7 @@ public:
     }
 
     void run(void) {
-        switch (mnt.meta.bsize) {
-        case 8:  run_<std::uint8_t >(); break;
-        case 16: run_<std::uint16_t>(); break;
-        case 32: run_<std::uint32_t>(); break;
-        case 64: run_<std::uint64_t>(); break;
-        }
+        dispatch(this);
     }
 };
 
@@ -255,6 +242,7 @@ public:
     template<class IntType>
     void QuickSort(std::size_t M, std::size_t N) { // [M, N)
         if (M >= N - 1) return;
+        poll();
         // Partition(A, M, N, I, J)
         IntType pivot = at<IntType>(M);
         std::size_t I = M - 1;
@@ -276,12 +264,7 @@ public:
     }
 
     void run(void) {
-        switch (mnt.meta.bsize) {
-        case 8:  run_<std::uint8_t >(); break;
-        case 16: run_<std::uint16_t>(); break;
-        case 32: run_<std::uint32_t>(); break;
-        case 64: run_<std::uint64_t>(); break;
-        }
+        dispatch(this);
     }
 };
 
@@ -299,6 +282,7 @@ public:
     template<class IntType>
     void QuickSort(std::size_t M, std::size_t N) { // [M, N)
         if (M >= N - 1) return;
+        poll();
         // Partition(A, M, N, I, J)
         IntType pivot = Mid(at<IntType>(M), at<IntType>((M+N-1)/2), at<IntType>(N - 1));
         std::size_t I = M - 1;
@@ -320,18 +304,14 @@ public:
     }
 
     void run(void) {
-        switch (mnt.meta.bsize) {
-        case 8:  run_<std::uint8_t >(); break;
-        case 16: run_<std::uint16_t>(); break;
-        case 32: run_<std::uint32_t>(); break;
-        case 64: run_<std::uint64_t>(); break;
-        }
+        dispatch(this);
     }
 };
 
 class Library : public SortBase {
 private:
     static constexpr std::size_t spreading_factor = 3;
+    std::vector<std::uint8_t> scratch; // keys gathered by Rebalance, sized for the mounted dataset in every run
 
 public:
     Library(Mount& _mnt) : SortBase(_mnt) {}
@@ -340,10 +320,10 @@ public:
     void Rebalance(std::vector<IntType>& S, std::size_t total) {
         std::size_t step_size = S.size() / (total+1);
 
-        static std::vector<IntType> T(size<IntType>());
+        IntType* T = reinterpret_cast<IntType*>(scratch.data());
         std::size_t i, k = 0;
         for (i = 0; i < S.size(); ++i) {
-            if (S[i]) { tr.access<3>();
+            if (S[i]) { tr.access<3>(); manual_move<IntType, 2>();
                 T[k++] = S[i];
                 S[i] = 0;
             }
@@ -351,7 +331,7 @@ public:
 
         i = 0;
         for (std::size_t w = step_size; i < k; w += step_size) {
-            S[w] = T[i++]; tr.access<2>();
+            S[w] = T[i++]; tr.access<2>(); manual_move<IntType, 1>();
         }
     }
 
@@ -372,6 +352,7 @@ public:
      void run_(void) {
          std::size_t N = size<IntType>();
          std::size_t S_size = N * 3;
+         scratch.resize(N * sizeof(IntType));
  
          std::vector<IntType> S(S_size); // [!] gap = 0, needs to assure there's no 0 in data
  
@@ -383,6 +364,7 @@ public:
          std::size_t insertion;
  
          while (total < N) {
+             poll();
              insertion = std::min(N - total, (round <<= 1));
              Rebalance(S, total);
              std::vector<std::pair<IntType, std::size_t>> sorted(total);
@@ -395,6 +377,7 @@ public:
              }
  
              for (std::size_t j = total; j < total + insertion; ++j) {
+                 poll();
                  IntType val = at<IntType>(j);
                  std::size_t idx = BinarySearch(sorted, val); // S[idx] <= val
  
@@ -417,18 +400,18 @@ public:
                          IntType& occupied = S[++idx]; tr.access<1>();
                          if (!occupied) break;
                          tr.comp<1>();
-                         if (val < occupied) { std::swap(occupied, val); tr.access<3>(); }
+                         if (val < occupied) { std::swap(occupied, val); tr.access<3>(); manual_move<IntType, 3>(); }
                      }
                  } else { // insert-left
                      while (true) {
                          IntType& occupied = S[--idx]; tr.access<1>();
                          if (!occupied) break;
                          tr.comp<1>();
-                         if (val > occupied) { std::swap(occupied, val); tr.access<3>(); }
+                         if (val > occupied) { std::swap(occupied, val); tr.access<3>(); manual_move<IntType, 3>(); }
                          // to be stable, >= instead of >
                      }
                  }
-                 S[idx] = val; tr.access<1>();
+                 S[idx] = val; tr.access<1>(); manual_move<IntType, 1>();
              }
              total += insertion;
          }
@@ -441,12 +424,7 @@ public:
      }
  
      void run(void) {
-         switch (mnt.meta.bsize) {
-         case 8:  run_<std::uint8_t >(); break;
-         case 16: run_<std::uint16_t>(); break;
-         case 32: run_<std::uint32_t>(); break;
-         case 64: run_<std::uint64_t>(); break;
-         }
+         dispatch_unsigned(this); // zero marks an empty gap slot
      }
  };
 
@@ -460,6 +438,7 @@ public:
         
         bool swapped;
         while (true) {
+            poll();
             if (end - begin < 1) break;
 
             // forward
@@ -489,12 +468,7 @@ public:
     }
 
     void run(void) {
-        switch (mnt.meta.bsize) {
-        case 8:  run_<std::uint8_t >(); break;
-        case 16: run_<std::uint16_t>(); break;
-        case 32: run_<std::uint32_t>(); break;
-        case 64: run_<std::uint64_t>(); break;
-        }
+        dispatch(this);
     }
 };
 
@@ -526,6 +500,7 @@ public:
         std::size_t N = size<IntType>();
         std::size_t i, inc = N;
         while ((inc = static_cast<std::size_t>(inc / 1.3)) > 1) {
+            poll();
             for (i = 0; i < N - inc; ++i) {
                 if (!lte<IntType>(i, i + inc))
                     swap<IntType>(i, i + inc);
@@ -534,6 +509,7 @@ public:
         // inc = 1 (bubble)
         bool swapped = true;
         while (swapped) {
+            poll();
             swapped = false;
             for (i = 0; i < N - 1; ++i) {
                 if (!lte<IntType>(i, i + 1)) {
@@ -546,12 +522,7 @@ public:
     }
 
     void run(void) {
-        switch (mnt.meta.bsize) {
-        case 8:  run_<std::uint8_t >(); break;
-        case 16: run_<std::uint16_t>(); break;
-        case 32: run_<std::uint32_t>(); break;
-        case 64: run_<std::uint64_t>(); break;
-        }
+        dispatch(this);
     }
 };
 
@@ -577,7 +548,7 @@ public:
     void run_(void) {
         std::size_t N = size<IntType>();
         std::vector<std::size_t> T(2*N, INF);
-        std::vector<std::size_t> R(N);
+        std::vector<IntType> R(N);
 
         std::size_t i, j;
         for (i = 0; i < N; ++i) {
@@ -590,8 +561,9 @@ public:
         }
     
         for (j = 0; j < N; ++j) {
+            poll();
             std::size_t min = T[1];    tr.access<1>();
-            R[j] = at<IntType>(min);   tr.access<1>();
+            R[j] = at<IntType>(min);   tr.access<1>(); manual_move<IntType, 1>();
             i = N + min;
             T[i] = INF;                tr.access<1>();
             while (i >>= 1) {
@@ -605,18 +577,13 @@ public:
     }
 
     void run(void) {
-        switch (mnt.meta.bsize) {
-        case 8:  run_<std::uint8_t>(); break;
-        case 16: run_<std::uint16_t>(); break;
-        case 32: run_<std::uint32_t>(); break;
-        case 64: run_<std::uint64_t>(); break;
-        }
+        dispatch(this);
     }
 };
 
 class Introsort : public SortBase {
 public:
-    Introsort(Mount& _mnt) : SortBase(_mnt) {}
+    Introsort(Mount& _mnt, SmallSort _small = SmallSort::INSERTION) : SortBase(_mnt), small(_small) {}
 
     template<class IntType>
     void SwopHeap(std::size_t low, std::size_t high, IntType in, IntType& out) {
@@ -662,8 +629,10 @@ public:
 
     template<class IntType>
     void SetHeap(std::size_t low, std::size_t high) {
-        for (std::size_t j = low + 1; j < high; ++j)
+        for (std::size_t j = low + 1; j < high; ++j) {
+            poll();
             InHeap<IntType>(low, high, j, at<IntType>(j));
+        }
     }
 
     template<class IntType>
@@ -671,6 +640,7 @@ public:
         IntType out;
         SetHeap<IntType>(low, high); // in-place rearrangement
         for (std::size_t i = high - 1; i > low; --i) {
+            poll();
             OutHeap<IntType>(low, high, out);
             set_val<IntType>(i, out);
             --high;
@@ -694,28 +664,35 @@ public:
         return c;
     }
 
+    template<class IntType>
+    std::size_t Partition(std::size_t low, std::size_t high) { // Hoare partition around median of three
+        IntType pivot = Median(at<IntType>(low), at<IntType>((low + high - 1) / 2), at<IntType>(high - 1));
+        std::size_t i = low - 1, j = high;
+        while (true) {
+            do { --j; } while (gt_direct<IntType>(at<IntType>(j), pivot));
+            do { ++i; } while (lt_direct<IntType>(at<IntType>(i), pivot));
+            if (i < j) swap<IntType>(i, j);
+            else break;
+        }
+        return j + 1;
+    }
+
     template<class IntType>
     void IntroLoop(std::size_t low, std::size_t high, std::size_t depth) {
-        std::size_t i, j, mid;
+        std::size_t mid;
         while (high - low > 16) {
+            poll(); // once per partition
             if (depth-- == 0) {
                 HeapSort<IntType>(low, high);
                 return;
             } else {
-                IntType pivot = Median(at<IntType>(low), at<IntType>((low + high - 1) / 2), at<IntType>(high - 1));
-                i = low - 1, j = high;
-                while (true) {
-                    do { --j; } while (gt_direct<IntType>(at<IntType>(j), pivot));
-                    do { ++i; } while (lt_direct<IntType>(at<IntType>(i), pivot));
-                    if (i < j) swap<IntType>(i, j);
-                    else break;
-                }
-                mid = j + 1;
+                mid = Partition<IntType>(low, high);
                 IntroLoop<IntType>(mid, high, depth);
                 high = mid; //tail-recursion
             }
         }
-        InsertionSort<IntType>(low, high);
+        if (small != SmallSort::NETWORK || !network<IntType>(low, high))
+            InsertionSort<IntType>(low, high);
     }
 
     std::size_t log2(std::size_t n) {
@@ -732,13 +709,11 @@ public:
     }
 
     void run(void) {
-        switch (mnt.meta.bsize) {
-        case 8:  run_<std::uint8_t>(); break;
-        case 16: run_<std::uint16_t>(); break;
-        case 32: run_<std::uint32_t>(); break;
-        case 64: run_<std::uint64_t>(); break;
-        }
+        dispatch(this);
     }
+
+protected:
+    const SmallSort small;
 };
 
 class Tim : public SortBase {
@@ -746,7 +721,7 @@ private:
     static constexpr std::size_t MIN_MERGE = 32;
 
 public:
-    Tim(Mount& _mnt) : SortBase(_mnt) {}
+    Tim(Mount& _mnt, SmallSort _small = SmallSort::INSERTION) : SortBase(_mnt), small(_small) {}
 
     template<class IntType>
     std::size_t FindRun(std::size_t begin, std::size_t N) {
@@ -778,9 +753,11 @@ public:
 
     template<class IntType>
     void Merge(std::size_t low, std::size_t mid, std::size_t high) {
+        poll();
         std::vector<IntType> left(mid - low);
-        for (std::size_t i = 0; i < left.size(); ++i)
-            left[i] = at<IntType>(low + i);
+        for (std::size_t i = 0; i < left.size(); ++i) {
+            left[i] = at<IntType>(low + i); manual_move<IntType, 1>();
+        }
 
         std::size_t i = 0, j = mid, k = low;
         while (i < left.size() && j < high) {
@@ -864,13 +841,15 @@ public:
         std::size_t i = 0;
 
         while (i < N) {
+            poll();
             std::size_t run_begin = i;
             std::size_t run_end = FindRun<IntType>(i, N);
 
             std::size_t run_len = run_end - run_begin;
             if (run_len < minrun) {
                 std::size_t forced_end = std::min(N, run_begin + minrun);
-                InsertionSort<IntType>(run_begin, forced_end);
+                if (small != SmallSort::NETWORK || !network<IntType>(run_begin, forced_end))
+                    InsertionSort<IntType>(run_begin, forced_end);
                 run_end = forced_end;
             }
 
@@ -884,12 +863,801 @@ public:
     }
 
     void run(void) {
-        switch (mnt.meta.bsize) {
-        case 8:  run_<std::uint8_t>(); break;
-        case 16: run_<std::uint16_t>(); break;
-        case 32: run_<std::uint32_t>(); break;
-        case 64: run_<std::uint64_t>(); break;
+        dispatch(this);
+    }
+
+protected:
+    const SmallSort small;
+};
+
+class Network : public Tim { // sorting network on every NETWORK_MAX block, the blocks are merged as Tim's runs
+public:
+    Network(Mount& _mnt) : Tim(_mnt, SmallSort::NETWORK) {}
+
+    template<class IntType>
+    void run_() {
+        std::size_t N = size<IntType>();
+        std::vector<std::pair<std::size_t, std::size_t>> run_stack;
+        for (std::size_t low = 0; low < N; low += NETWORK_MAX) {
+            poll();
+            std::size_t high = std::min(N, low + NETWORK_MAX);
+            if (!network<IntType>(low, high)) InsertionSort<IntType>(low, high);
+            run_stack.emplace_back(low, high);
+            MergeCollapse<IntType>(run_stack);
+        }
+        MergeForceCollapse<IntType>(run_stack);
+    }
+
+    void run(void) {
+        dispatch(this);
+    }
+};
+
+class External : public Introsort { // external merge sort: the input is streamed into sorted runs on disk, k-way merged by a loser tree into a result file
+private:
+    const std::size_t run_size; // #elements sorted in memory per run
+    std::unique_ptr<TempDir> scratch; // runs and the result of the last run(), kept until validated
+
+public:
+    External(Mount& _mnt, std::size_t _run_size) : Introsort(_mnt), run_size(std::max<std::size_t>(_run_size, 1)) {}
+
+    template<class IntType>
+    bool Beats(const std::vector<IntType>& head, const std::vector<bool>& done, std::size_t a, std::size_t b) {
+        if (done[a]) return false;
+        if (done[b]) return true;
+        return lte_direct<IntType>(head[a], head[b]);
+    }
+
+    template<class IntType>
+    std::size_t Build(std::vector<std::size_t>& loser, const std::vector<IntType>& head, const std::vector<bool>& done, std::size_t node) {
+        std::size_t k = loser.size();
+        if (node >= k) return node - k; // leaf
+        std::size_t l = Build<IntType>(loser, head, done, 2 * node);
+        std::size_t r = Build<IntType>(loser, head, done, 2 * node + 1);
+        if (Beats<IntType>(head, done, l, r)) {
+            loser[node] = r;
+            return l;
+        }
+        loser[node] = l;
+        return r;
+    }
+
+    template<class IntType>
+    void MergeRuns(std::vector<Source<IntType>>& runs, Stream<IntType>& sink) {
+        std::size_t k = runs.size();
+        if (k == 0) return;
+        std::vector<IntType> head(k);
+        std::vector<bool> done(k);
+        std::vector<std::size_t> loser(k); // loser[0] holds the overall winner
+        for (std::size_t r = 0; r < k; ++r)
+            done[r] = !(runs[r] >> head[r]);
+        loser[0] = Build<IntType>(loser, head, done, 1);
+
+        for (std::size_t until_poll = run_size;; ) {
+            std::size_t w = loser[0];
+            if (done[w]) break;
+            if (--until_poll == 0) { poll(); until_poll = run_size; } // once per run's worth of output
+            sink << head[w]; manual_access<1>(); manual_move<IntType, 1>();
+            done[w] = !(runs[w] >> head[w]);
+            for (std::size_t node = (w + k) / 2; node > 0; node /= 2) { // replay the path to the root
+                if (Beats<IntType>(head, done, loser[node], w))
+                    std::swap(loser[node], w);
+            }
+            loser[0] = w;
+        }
+        for (auto& run : runs) tr.read(run.bytes());
+    }
+
+    // the next run of at most run_size elements from _input into the Mount's scratch space at _base, sorted;
+    // returns its length
+    template<class IntType>
+    std::size_t SortRun(Source<IntType>& input, std::size_t base) {
+        poll();
+        std::size_t len = 0;
+        for (IntType val; len < run_size && input >> val; ++len) set_val<IntType>(base + len, val);
+        IntroLoop<IntType>(base, base + len, 2 * log2(len));
+        return len;
+    }
+
+    template<class IntType>
+    void Spill(Stream<IntType>& sink, std::size_t low, std::size_t high) {
+        for (std::size_t i = low; i < high; ++i) sink << at<IntType>(i);
+        sink.flush();
+    }
+
+    template<class IntType>
+    void run_(void) {
+        const std::size_t N = mnt.meta.size;
+        Source<IntType> input = mnt.input<IntType>();
+        // next to the dataset rather than in a temp directory that may live in memory
+        std::filesystem::path parent = std::filesystem::path(mnt.meta.filename).parent_path();
+        scratch.reset(); // the previous result goes first
+        scratch = std::make_unique<TempDir>("external", parent.empty() ? std::filesystem::path(".") : parent);
+
+        // the Mount holds no more than one run, appended to whatever it keeps resident
+        const std::size_t base = size<IntType>();
+        mnt.reserve(std::min(N, run_size) * sizeof(IntType));
+
+        std::vector<std::string> files;
+        std::size_t len;
+        while ((len = SortRun<IntType>(input, base)) > 0) {
+            files.push_back(*scratch / ("run" + std::to_string(files.size())));
+            Stream<IntType> spill(files.back());
+            Spill<IntType>(spill, base, base + len);
+            tr.write(spill.bytes());
+        }
+        tr.read(input.bytes());
+
+        const std::string result = *scratch / "sorted";
+        if (files.size() == 1) { // a single run is the result
+            std::filesystem::rename(files.front(), result);
+        } else { // no run at all leaves an empty result
+            std::vector<Source<IntType>> runs;
+            runs.reserve(files.size());
+            for (const auto& file : files) runs.emplace_back(file);
+            Stream<IntType> sink(result);
+            MergeRuns<IntType>(runs, sink);
+            sink.flush();
+            tr.write(sink.bytes());
+        }
+        mnt.deliver(result);
+    }
+
+    void run(void) {
+        dispatch(this);
+    }
+};
+
+template<std::size_t Bits>
+class RadixLSD : public SortBase { // least significant digit first, Bits per digit
+private:
+    static constexpr std::size_t RADIX = std::size_t(1) << Bits;
+    static constexpr std::size_t MASK = RADIX - 1;
+    std::vector<std::uint8_t> scratch; // ping-pong buffer, kept across iterations
+
+public:
+    RadixLSD(Mount& _mnt) : SortBase(_mnt) {}
+
+    // digits come from the order-preserving unsigned image, so signed, float and record keys sort too
+    template<class IntType>
+    static inline std::size_t Digit(const IntType& val, std::size_t pass)
+    { return static_cast<std::size_t>(radix_key(val) >> (pass * Bits)) & MASK; }
+
+    template<class IntType>
+    void run_(void) {
+        constexpr std::size_t PASSES = (sizeof(radix_t<IntType>) * 8 + Bits - 1) / Bits;
+        std::size_t N = size<IntType>(), i, p;
+        if (N < 2) return;
+
+        // histograms of every digit in a single sweep
+        std::vector<std::size_t> count(PASSES * RADIX, 0);
+        for (i = 0; i < N; ++i) {
+            IntType val = at<IntType>(i);
+            for (p = 0; p < PASSES; ++p) ++count[p * RADIX + Digit(val, p)];
+        }
+
+        if (scratch.size() < N * sizeof(IntType)) scratch.resize(N * sizeof(IntType));
+        IntType* buffer = reinterpret_cast<IntType*>(scratch.data());
+        bool in_buffer = false;
+        for (p = 0; p < PASSES; ++p) {
+            poll();
+            std::size_t* bucket = count.data() + p * RADIX;
+            IntType first = in_buffer ? buffer[0] : at<IntType>(0);
+            if (bucket[Digit(first, p)] == N) continue; // every key shares this digit
+
+            std::size_t offset = 0;
+            for (std::size_t d = 0; d < RADIX; ++d) {
+                std::size_t c = bucket[d];
+                bucket[d] = offset;
+                offset += c;
+            }
+            if (!in_buffer) {
+                for (i = 0; i < N; ++i) {
+                    IntType val = at<IntType>(i);
+                    buffer[bucket[Digit(val, p)]++] = val; tr.access<1>(); manual_move<IntType, 1>();
+                }
+            } else {
+                for (i = 0; i < N; ++i) {
+                    IntType val = buffer[i];               tr.access<1>();
+                    set_val<IntType>(bucket[Digit(val, p)]++, val);
+                }
+            }
+            in_buffer = !in_buffer;
+        }
+
+        if (in_buffer) {
+            for (i = 0; i < N; ++i) {
+                set_val<IntType>(i, buffer[i]); tr.access<1>();
+            }
+        }
+    }
+
+    void run(void) {
+        dispatch(this);
+    }
+};
+
+class RadixMSD : public SortBase { // in-place most significant digit first radix sort (American flag sort)
+private:
+    static constexpr std::size_t RADIX = 256;
+    static constexpr std::size_t CUTOFF = 16;
+
+public:
+    RadixMSD(Mount& _mnt) : SortBase(_mnt) {}
+
+    template<class IntType>
+    static inline std::size_t Digit(const IntType& val, std::size_t shift)
+    { return static_cast<std::size_t>(radix_key(val) >> shift) & (RADIX - 1); }
+
+    template<class IntType>
+    void InsertionSort(std::size_t low, std::size_t high) {
+        for (std::size_t i = low + 1; i < high; ++i) {
+            for (std::size_t j = i; j > low && lte<IntType>(j, j - 1); --j)
+                swap<IntType>(j, j - 1);
+        }
+    }
+
+    template<class IntType>
+    void AmericanFlag(std::size_t low, std::size_t high, std::size_t shift) {
+        std::size_t count[RADIX], next[RADIX], end[RADIX];
+        std::size_t i, d;
+        while (true) {
+            poll(); // once per digit of a bucket
+            if (high - low <= CUTOFF) {
+                InsertionSort<IntType>(low, high);
+                return;
+            }
+            std::fill(count, count + RADIX, 0);
+            for (i = low; i < high; ++i) ++count[Digit(at<IntType>(i), shift)];
+            if (count[Digit(at<IntType>(low), shift)] != high - low) break;
+            if (shift == 0) return; // constant range
+            shift -= 8; // single bucket, nothing to permute at this digit
         }
+
+        for (d = 0, i = low; d < RADIX; ++d) {
+            next[d] = i;
+            i += count[d];
+            end[d] = i;
+        }
+
+        // cycle leader permutation: drop every key into its bucket in place
+        for (d = 0; d < RADIX; ++d) {
+            while (next[d] < end[d]) {
+                IntType val = at<IntType>(next[d]);
+                std::size_t dv = Digit(val, shift);
+                while (dv != d) {
+                    IntType displaced = at<IntType>(next[dv]);
+                    set_val<IntType>(next[dv]++, val);
+                    val = displaced;
+                    dv = Digit(val, shift);
+                }
+                set_val<IntType>(next[d]++, val);
+            }
+        }
+
+        if (shift == 0) return;
+        for (d = 0, i = low; d < RADIX; i += count[d++]) {
+            if (count[d] > 1) AmericanFlag<IntType>(i, i + count[d], shift - 8);
+        }
+    }
+
+    template<class IntType>
+    void run_(void) {
+        AmericanFlag<IntType>(0, size<IntType>(), (sizeof(radix_t<IntType>) - 1) * 8);
+    }
+
+    void run(void) {
+        dispatch(this);
+    }
+};
+
+class ParallelSample : public SortBase { // sample sort, buckets are sorted by Introsort workers on a thread pool
+private:
+    static constexpr std::size_t OVERSAMPLE = 32;
+    ThreadPool pool;
+    std::vector<std::uint8_t> scratch; // scatter buffer, kept across iterations
+
+public:
+    ParallelSample(Mount& _mnt, std::size_t _threads) : SortBase(_mnt), pool(_threads) {}
+
+    std::size_t threads(void) const
+    { return pool.size(); }
+
+    // bucket 2j holds (s[j-1], s[j]), bucket 2j+1 holds keys equal to s[j] and never needs sorting
+    template<class IntType>
+    std::size_t Classify(Introsort& worker, const std::vector<IntType>& splitters, IntType val) {
+        std::size_t low = 0, mid, high = splitters.size();
+        while (low < high) {
+            mid = (low + high) / 2;
+            if (worker.lt_direct<IntType>(splitters[mid], val)) low = mid + 1;
+            else                                                high = mid;
+        }
+        if (low < splitters.size() && worker.lte_direct<IntType>(splitters[low], val)) return 2 * low + 1;
+        return 2 * low;
+    }
+
+    template<class IntType>
+    void run_(void) {
+        std::size_t N = size<IntType>(), P = pool.size(), i;
+        std::vector<Introsort> workers(P, Introsort(mnt)); // one trace per thread
+        if (P == 1 || N < 2 * P * OVERSAMPLE) {
+            workers[0].IntroLoop<IntType>(0, N, 2 * workers[0].log2(N));
+            tr += workers[0].trace();
+            return;
+        }
+
+        std::vector<IntType> sample(P * OVERSAMPLE);
+        std::minstd_rand engine(static_cast<std::uint32_t>(N));
+        std::uniform_int_distribution<std::size_t> pick(0, N - 1);
+        for (auto& s : sample) s = at<IntType>(pick(engine));
+        std::sort(sample.begin(), sample.end(), [this](IntType a, IntType b) { return lt_direct<IntType>(a, b); });
+        std::vector<IntType> splitters;
+        for (i = 1; i < P; ++i) splitters.push_back(sample[i * OVERSAMPLE]);
+
+        const std::size_t B = 2 * splitters.size() + 1;
+        const std::size_t chunk = (N + P - 1) / P;
+        std::vector<std::size_t> offset(P * B, 0); // per (chunk, bucket)
+        parallel_for(pool, P, [&](std::size_t t, std::size_t w) {
+            poll();
+            std::size_t* count = offset.data() + t * B;
+            for (std::size_t j = t * chunk; j < std::min(N, (t + 1) * chunk); ++j)
+                ++count[Classify<IntType>(workers[w], splitters, workers[w].at<IntType>(j))];
+        });
+
+        std::vector<std::size_t> bucket(B + 1);
+        std::size_t total = 0;
+        for (std::size_t b = 0; b < B; ++b) {
+            bucket[b] = total;
+            for (std::size_t t = 0; t < P; ++t) {
+                std::size_t c = offset[t * B + b];
+                offset[t * B + b] = total;
+                total += c;
+            }
+        }
+        bucket[B] = N;
+
+        if (scratch.size() < N * sizeof(IntType)) scratch.resize(N * sizeof(IntType));
+        IntType* buffer = reinterpret_cast<IntType*>(scratch.data());
+        parallel_for(pool, P, [&](std::size_t t, std::size_t w) {
+            poll();
+            std::size_t* next = offset.data() + t * B;
+            for (std::size_t j = t * chunk; j < std::min(N, (t + 1) * chunk); ++j) {
+                IntType val = workers[w].at<IntType>(j);
+                buffer[next[Classify<IntType>(workers[w], splitters, val)]++] = val; workers[w].manual_access<1>();
+                workers[w].manual_move<IntType, 1>();
+            }
+        });
+
+        parallel_for(pool, B, [&](std::size_t b, std::size_t w) {
+            poll();
+            std::size_t low = bucket[b], high = bucket[b + 1];
+            for (std::size_t j = low; j < high; ++j) {
+                workers[w].set_val<IntType>(j, buffer[j]); workers[w].manual_access<1>();
+            }
+            if (b % 2 == 0 && high - low > 1)
+                workers[w].IntroLoop<IntType>(low, high, 2 * workers[w].log2(high - low));
+        });
+
+        for (const auto& worker : workers) tr += worker.trace();
+    }
+
+    void run(void) {
+        dispatch(this);
+    }
+};
+
+class ParallelMerge : public SortBase { // per-thread blocks merged pairwise, each merge split by co-rank into disjoint outputs
+private:
+    ThreadPool pool;
+
+public:
+    ParallelMerge(Mount& _mnt, std::size_t _threads) : SortBase(_mnt), pool(_threads) {}
+
+    std::size_t threads(void) const
+    { return pool.size(); }
+
+    // #elements of A=[a, a+m) among the first k outputs of merge(A, B=[b, b+n)), ties are taken from A
+    template<class IntType>
+    std::size_t CoRank(Introsort& worker, std::size_t k, std::size_t a, std::size_t m, std::size_t b, std::size_t n) {
+        std::size_t low = k > n ? k - n : 0, high = std::min(k, m);
+        while (low < high) {
+            std::size_t i = (low + high) / 2, j = k - i;
+            if (j > 0 && worker.lte<IntType>(a + i, b + j - 1)) low = i + 1;
+            else                                                 high = i;
+        }
+        return low;
+    }
+
+    template<class IntType>
+    void MergePiece(Introsort& worker, std::size_t a, std::size_t m, std::size_t b, std::size_t n,
+                    std::size_t out, std::size_t k_low, std::size_t k_high) {
+        poll();
+        std::size_t i = CoRank<IntType>(worker, k_low, a, m, b, n), j = k_low - i;
+        std::size_t i_end = CoRank<IntType>(worker, k_high, a, m, b, n), j_end = k_high - i_end;
+        std::size_t k = out + k_low;
+        while (i < i_end && j < j_end) {
+            if (worker.lte<IntType>(a + i, b + j)) worker.set<IntType>(k++, a + i++);
+            else                                   worker.set<IntType>(k++, b + j++);
+        }
+        while (i < i_end) worker.set<IntType>(k++, a + i++);
+        while (j < j_end) worker.set<IntType>(k++, b + j++);
+    }
+
+    template<class IntType>
+    void run_(void) {
+        std::size_t N = size<IntType>(), P = pool.size();
+        std::vector<Introsort> workers(P, Introsort(mnt)); // one trace per thread
+        if (P == 1 || N < 2 * P) {
+            workers[0].IntroLoop<IntType>(0, N, 2 * workers[0].log2(N));
+            tr += workers[0].trace();
+            return;
+        }
+
+        std::vector<std::size_t> bound;
+        const std::size_t piece = (N + P - 1) / P;
+        for (std::size_t low = 0; low < N; low += piece) bound.push_back(low);
+        bound.push_back(N);
+        parallel_for(pool, bound.size() - 1, [&](std::size_t t, std::size_t w) {
+            workers[w].IntroLoop<IntType>(bound[t], bound[t + 1], 2 * workers[w].log2(bound[t + 1] - bound[t]));
+        });
+
+        mnt.reserve(mnt.size<char>()); // [N, 2N) is the other half of the ping-pong
+        std::size_t src = 0, dst = N;
+        while (bound.size() > 2) {
+            struct Task { std::size_t a, m, b, n, k_low, k_high; };
+            std::vector<Task> tasks;
+            std::vector<std::size_t> merged;
+            for (std::size_t r = 0; r + 1 < bound.size(); r += 2) {
+                std::size_t a = bound[r], m = bound[r + 1] - a;
+                std::size_t b = bound[r + 1], n = (r + 2 < bound.size()) ? bound[r + 2] - b : 0;
+                for (std::size_t k = 0; k < m + n; k += piece)
+                    tasks.push_back({a, m, b, n, k, std::min(m + n, k + piece)});
+                merged.push_back(a);
+            }
+            merged.push_back(N);
+            parallel_for(pool, tasks.size(), [&](std::size_t t, std::size_t w) {
+                const Task& task = tasks[t];
+                MergePiece<IntType>(workers[w], src + task.a, task.m, src + task.b, task.n,
+                                    dst + task.a, task.k_low, task.k_high);
+            });
+            bound.swap(merged);
+            std::swap(src, dst);
+        }
+
+        if (src != 0) {
+            parallel_for(pool, P, [&](std::size_t t, std::size_t w) {
+                poll();
+                for (std::size_t i = t * piece; i < std::min(N, (t + 1) * piece); ++i)
+                    workers[w].set<IntType>(i, src + i);
+            });
+        }
+        for (const auto& worker : workers) tr += worker.trace();
+    }
+
+    void run(void) {
+        dispatch(this);
+    }
+};
+
+class ParallelIntrosort : public SortBase { // partitions above the cutoff are spawned as stealable tasks
+private:
+    static constexpr std::size_t SPAWN_CUTOFF = 1 << 13;
+    WorkStealingPool pool;
+
+public:
+    ParallelIntrosort(Mount& _mnt, std::size_t _threads) : SortBase(_mnt), pool(_threads) {}
+
+    std::size_t threads(void) const
+    { return pool.size(); }
+
+    template<class IntType>
+    void IntroTask(std::vector<Introsort>& workers, std::size_t w, std::size_t low, std::size_t high, std::size_t depth) {
+        Introsort& worker = workers[w];
+        std::size_t mid;
+        while (high - low > SPAWN_CUTOFF) {
+            poll();
+            if (depth-- == 0) {
+                worker.HeapSort<IntType>(low, high);
+                return;
+            }
+            mid = worker.Partition<IntType>(low, high);
+            pool.spawn([this, &workers, mid, high, depth](std::size_t thief) {
+                IntroTask<IntType>(workers, thief, mid, high, depth);
+            }, w);
+            high = mid;
+        }
+        worker.IntroLoop<IntType>(low, high, depth); // same heap-sort guard and 16-element insertion cutoff
+    }
+
+    template<class IntType>
+    void run_(void) {
+        std::size_t N = size<IntType>();
+        std::vector<Introsort> workers(pool.size(), Introsort(mnt)); // one trace per thread
+        std::size_t depth = 2 * workers[0].log2(N);
+        pool.spawn([this, &workers, N, depth](std::size_t w) {
+            IntroTask<IntType>(workers, w, 0, N, depth);
+        });
+        pool.wait();
+        for (const auto& worker : workers) tr += worker.trace();
+    }
+
+    void run(void) {
+        dispatch(this);
+    }
+};
+
+class BlockQuick : public Introsort { // BlockQuicksort (Edelkamp & Weiss), comparison results are buffered as offsets
+private:
+    static constexpr std::size_t BLOCK = 64;
+
+public:
+    BlockQuick(Mount& _mnt) : Introsort(_mnt) {}
+
+    template<class IntType>
+    void Sort2(std::size_t a, std::size_t b)
+    { if (lt<IntType>(b, a)) swap<IntType>(a, b); }
+
+    template<class IntType>
+    void Sort3(std::size_t a, std::size_t b, std::size_t c)
+    { Sort2<IntType>(a, b); Sort2<IntType>(b, c); Sort2<IntType>(a, b); }
+
+    // pivot at A[low], requires some A[i] >= pivot in (low, high); returns the final pivot position
+    // and whether the range was already partitioned
+    template<class IntType>
+    std::pair<std::size_t, bool> PartitionBlock(std::size_t low, std::size_t high) {
+        IntType pivot = at<IntType>(low);
+        std::size_t first = low, last = high;
+        while (lt_direct<IntType>(at<IntType>(++first), pivot));
+        if (first - 1 == low) while (first < last && !lt_direct<IntType>(at<IntType>(--last), pivot));
+        else                  while (               !lt_direct<IntType>(at<IntType>(--last), pivot));
+
+        bool already_partitioned = first >= last;
+        if (!already_partitioned) {
+            swap<IntType>(first++, last);
+
+            unsigned char offsets_l[BLOCK], offsets_r[BLOCK];
+            std::size_t base_l = first, base_r = last;
+            std::size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0, i;
+            while (first < last) {
+                // fill the offset buffers with the elements on the wrong side, no branch depends on the data
+                std::size_t unknown = last - first;
+                std::size_t split_l = num_l == 0 ? (num_r == 0 ? unknown / 2 : unknown) : 0;
+                std::size_t split_r = num_r == 0 ? unknown - split_l : 0;
+                split_l = std::min(split_l, BLOCK);
+                split_r = std::min(split_r, BLOCK);
+                for (i = 0; i < split_l;) {
+                    offsets_l[num_l] = static_cast<unsigned char>(i++);
+                    num_l += !lt_direct<IntType>(at<IntType>(first++), pivot);
+                }
+                for (i = 0; i < split_r;) {
+                    offsets_r[num_r] = static_cast<unsigned char>(++i);
+                    num_r += lt_direct<IntType>(at<IntType>(--last), pivot);
+                }
+
+                // swap the misplaced pairs in one batch
+                std::size_t num = std::min(num_l, num_r);
+                for (i = 0; i < num; ++i)
+                    swap<IntType>(base_l + offsets_l[start_l + i], base_r - offsets_r[start_r + i]);
+                num_l -= num; num_r -= num;
+                start_l += num; start_r += num;
+                if (num_l == 0) { start_l = 0; base_l = first; }
+                if (num_r == 0) { start_r = 0; base_r = last; }
+            }
+
+            // leftovers of a single side are moved next to the boundary
+            if (num_l) {
+                while (num_l--) swap<IntType>(base_l + offsets_l[start_l + num_l], --last);
+                first = last;
+            }
+            if (num_r) {
+                while (num_r--) swap<IntType>(base_r - offsets_r[start_r + num_r], first++);
+                last = first;
+            }
+        }
+
+        std::size_t pivot_pos = first - 1;
+        set<IntType>(low, pivot_pos);
+        set_val<IntType>(pivot_pos, pivot);
+        return std::make_pair(pivot_pos, already_partitioned);
+    }
+
+    template<class IntType>
+    void BlockLoop(std::size_t low, std::size_t high, std::size_t depth) {
+        while (high - low > 16) {
+            poll();
+            if (depth-- == 0) {
+                HeapSort<IntType>(low, high);
+                return;
+            }
+            std::size_t mid = low + (high - low) / 2;
+            Sort3<IntType>(low, mid, high - 1);
+            swap<IntType>(low, mid); // median to the front, A[high-1] >= pivot bounds the scans
+            std::size_t pivot_pos = PartitionBlock<IntType>(low, high).first;
+            BlockLoop<IntType>(pivot_pos + 1, high, depth);
+            high = pivot_pos; //tail-recursion
+        }
+        InsertionSort<IntType>(low, high);
+    }
+
+    template<class IntType>
+    void run_(void) {
+        std::size_t N = size<IntType>();
+        BlockLoop<IntType>(0, N, 2 * log2(N));
+    }
+
+    void run(void) {
+        dispatch(this);
+    }
+};
+
+class PatternDefeating : public BlockQuick { // pdqsort (Peters), block partition with pattern detection
+private:
+    static constexpr std::size_t INSERTION_THRESHOLD = 24;
+    static constexpr std::size_t NINTHER_THRESHOLD = 128;
+    static constexpr std::size_t PARTIAL_INSERTION_LIMIT = 8;
+
+public:
+    PatternDefeating(Mount& _mnt) : BlockQuick(_mnt) {}
+
+    // insertion sort that gives up after PARTIAL_INSERTION_LIMIT moves, true if [low, high) got sorted
+    template<class IntType>
+    bool PartialInsertionSort(std::size_t low, std::size_t high) {
+        std::size_t moved = 0;
+        for (std::size_t i = low + 1; i < high; ++i) {
+            if (!lt<IntType>(i, i - 1)) continue;
+            IntType val = at<IntType>(i);
+            std::size_t j = i;
+            do { set<IntType>(j, j - 1); --j; } while (j > low && lt_direct<IntType>(val, at<IntType>(j - 1)));
+            set_val<IntType>(j, val);
+            moved += i - j;
+            if (moved > PARTIAL_INSERTION_LIMIT) return false;
+        }
+        return true;
+    }
+
+    // keys equal to the pivot A[low] go to the left side, returns the final pivot position
+    template<class IntType>
+    std::size_t PartitionLeft(std::size_t low, std::size_t high) {
+        IntType pivot = at<IntType>(low);
+        std::size_t first = low, last = high;
+        while (lt_direct<IntType>(pivot, at<IntType>(--last)));
+        if (last + 1 == high) while (first < last && !lt_direct<IntType>(pivot, at<IntType>(++first)));
+        else                  while (               !lt_direct<IntType>(pivot, at<IntType>(++first)));
+        while (first < last) {
+            swap<IntType>(first, last);
+            while (lt_direct<IntType>(pivot, at<IntType>(--last)));
+            while (!lt_direct<IntType>(pivot, at<IntType>(++first)));
+        }
+        set<IntType>(low, last);
+        set_val<IntType>(last, pivot);
+        return last;
+    }
+
+    template<class IntType>
+    void BreakPatterns(std::size_t low, std::size_t high) { // swaps a few keys to escape adversarial patterns
+        std::size_t size = high - low;
+        if (size < INSERTION_THRESHOLD) return;
+        swap<IntType>(low, low + size / 4);
+        swap<IntType>(high - 1, high - size / 4);
+        if (size > NINTHER_THRESHOLD) {
+            swap<IntType>(low + 1, low + (size / 4 + 1));
+            swap<IntType>(low + 2, low + (size / 4 + 2));
+            swap<IntType>(high - 2, high - (size / 4 + 1));
+            swap<IntType>(high - 3, high - (size / 4 + 2));
+        }
+    }
+
+    template<class IntType>
+    void PdqLoop(std::size_t low, std::size_t high, std::size_t bad_allowed, bool leftmost) {
+        while (true) {
+            poll();
+            std::size_t size = high - low;
+            if (size < INSERTION_THRESHOLD) {
+                InsertionSort<IntType>(low, high);
+                return;
+            }
+
+            std::size_t half = size / 2;
+            if (size > NINTHER_THRESHOLD) { // pseudomedian of nine
+                Sort3<IntType>(low, low + half, high - 1);
+                Sort3<IntType>(low + 1, low + (half - 1), high - 2);
+                Sort3<IntType>(low + 2, low + (half + 1), high - 3);
+                Sort3<IntType>(low + (half - 1), low + half, low + (half + 1));
+                swap<IntType>(low, low + half);
+            } else {
+                Sort3<IntType>(low + half, low, high - 1);
+            }
+
+            // the pivot equals its left neighbour, which bounds this range: take all equal keys at once
+            if (!leftmost && !lt<IntType>(low - 1, low)) {
+                low = PartitionLeft<IntType>(low, high) + 1;
+                continue;
+            }
+
+            auto [pivot_pos, already_partitioned] = PartitionBlock<IntType>(low, high);
+            std::size_t l_size = pivot_pos - low, r_size = high - (pivot_pos + 1);
+            if (l_size < size / 8 || r_size < size / 8) { // highly unbalanced
+                if (--bad_allowed == 0) {
+                    HeapSort<IntType>(low, high);
+                    return;
+                }
+                BreakPatterns<IntType>(low, pivot_pos);
+                BreakPatterns<IntType>(pivot_pos + 1, high);
+            } else if (already_partitioned && PartialInsertionSort<IntType>(low, pivot_pos)
+                                           && PartialInsertionSort<IntType>(pivot_pos + 1, high)) {
+                return;
+            }
+
+            PdqLoop<IntType>(low, pivot_pos, bad_allowed, leftmost);
+            low = pivot_pos + 1; //tail-recursion
+            leftmost = false;
+        }
+    }
+
+    template<class IntType>
+    void run_(void) {
+        std::size_t N = size<IntType>();
+        PdqLoop<IntType>(0, N, log2(N) + 1, true);
+    }
+
+    void run(void) {
+        dispatch(this);
+    }
+};
+
+class VectorQuick : public Introsort { // introsort partitioning a vector of keys per step: AVX-512 compress-store or AVX2 permutation table
+public:
+    VectorQuick(Mount& _mnt, SmallSort _small = SmallSort::INSERTION) : Introsort(_mnt, _small) {}
+
+    // [low, high) split around the pivot value, returns where the keys not going left begin
+    template<class IntType, bool Strict>
+    std::size_t VectorPartition(std::size_t low, std::size_t high, const IntType& pivot) {
+        const std::size_t n = high - low; // every key read, compared and written once
+        manual_access(2 * n);
+        manual_comp(n);
+        manual_move<IntType>(n);
+        return low + partition_keys<Strict>(&mnt.at<IntType>(low), high - low, pivot);
+    }
+
+    // Tukey's ninther: the partition leaves no order the median of three could rely on, e.g. sorted input comes
+    // out interleaved from both ends
+    template<class IntType>
+    IntType Pivot(std::size_t low, std::size_t high) {
+        const std::size_t step = (high - low) / 8, mid = low + (high - low) / 2;
+        return Median(Median(at<IntType>(low), at<IntType>(low + step), at<IntType>(low + 2 * step)),
+                      Median(at<IntType>(mid - step), at<IntType>(mid), at<IntType>(mid + step)),
+                      Median(at<IntType>(high - 1 - 2 * step), at<IntType>(high - 1 - step), at<IntType>(high - 1)));
+    }
+
+    template<class IntType>
+    void VectorLoop(std::size_t low, std::size_t high, std::size_t depth) {
+        while (high - low > 16) {
+            poll();
+            if (depth-- == 0) {
+                HeapSort<IntType>(low, high);
+                return;
+            }
+            IntType pivot = Pivot<IntType>(low, high);
+            std::size_t mid = VectorPartition<IntType, true>(low, high, pivot);
+            if (mid == low) { // nothing below the pivot: the keys equal to it are gathered in front and done
+                low = VectorPartition<IntType, false>(low, high, pivot);
+                continue;
+            }
+            VectorLoop<IntType>(mid, high, depth);
+            high = mid; //tail-recursion
+        }
+        if (small != SmallSort::NETWORK || !network<IntType>(low, high))
+            InsertionSort<IntType>(low, high);
+    }
+
+    template<class IntType>
+    void run_(void) {
+        std::size_t N = size<IntType>();
+        VectorLoop<IntType>(0, N, 2 * log2(N));
+    }
+
+    void run(void) {
+        dispatch(this);
     }
 };
 
@@ -2,13 +2,23 @@
 #define SORTBASE_HPP
 
 #include <algorithm>
+#include <stdexcept>
 
 #include "trace.hpp"
 #include "filesys.hpp"
+#include "network.hpp"
+
+class SortCancelled : public std::runtime_error { // thrown out of run() once the time budget is exhausted
+public:
+    SortCancelled() : std::runtime_error("Sort cancelled") {}
+};
+
+enum class SmallSort { INSERTION, NETWORK }; // base case of the hybrid sorts
 
 class SortBase {
 public:
     SortBase(Mount& _mnt) : mnt(_mnt) {}
+    virtual ~SortBase() = default;
 
     template<class IntType>
     inline IntType& at(std::size_t _idx)
@@ -16,12 +26,13 @@ public:
 
     template<class IntType>
     inline void set(std::size_t _idx1, std::size_t _idx2)
-    { tr.access<2>(); mnt.at<IntType>(_idx1) = mnt.at<IntType>(_idx2); }
+    { tr.access<2>(); manual_move<IntType, 1>(); mnt.at<IntType>(_idx1) = mnt.at<IntType>(_idx2); }
 
     template<class IntType>
     inline void set_val(std::size_t _idx, const IntType& _val)
-    { tr.access<1>(); mnt.at<IntType>(_idx) = _val; }
+    { tr.access<1>(); manual_move<IntType, 1>(); mnt.at<IntType>(_idx) = _val; }
 
+    // _val1 is a local, e.g. a saved key, so nothing is moved in the data
     template<class IntType>
     inline void set_direct(IntType& _val1, const IntType& _val2)
     { tr.access<1>(); _val1 = _val2; }
@@ -60,7 +71,7 @@ public:
 
     template<class IntType>
     inline void swap(std::size_t _idx1, std::size_t _idx2) {
-        tr.access<3>();
+        tr.access<3>(); manual_move<IntType, 3>();
         IntType& a = mnt.at<IntType>(_idx1);
         IntType& b = mnt.at<IntType>(_idx2);
         IntType t = a; a = b; b = t;
@@ -70,14 +81,24 @@ public:
     std::size_t size(void) const
     { return mnt.size<IntType>(); }
 
-    inline const Trace& trace(void) const
+    inline const TracePolicy& trace(void) const
     { return tr; }
 
+    inline void reset_trace(void)
+    { tr.reset(); }
+
+    // asks every sorter working on the same Mount to stop at its next poll
+    inline void cancel(bool _cancelled = true)
+    { mnt.cancelled = _cancelled; }
+
     inline bool validate(bool verbose = false) const
     { return mnt.validate(verbose); }
 
     virtual void run(void) = 0;
 
+    virtual std::size_t threads(void) const
+    { return 1; }
+
     template<std::int_fast64_t Diff>
     inline void manual_access()
     { tr.access<Diff>(); }
@@ -86,9 +107,71 @@ public:
     inline void manual_comp()
     { tr.comp<Diff>(); }
 
+    // for elements copied outside the helpers above, e.g. into a scratch buffer
+    template<class IntType, std::int_fast64_t Diff>
+    inline void manual_move()
+    { tr.move(Diff * sizeof(IntType), Diff * (sizeof(IntType) - sizeof(key_type_t<IntType>))); }
+
+    // the same for a run-time count, charged once for a whole block
+    inline void manual_access(std::int_fast64_t _diff)
+    { tr.access(_diff); }
+
+    inline void manual_comp(std::int_fast64_t _diff)
+    { tr.comp(_diff); }
+
+    template<class IntType>
+    inline void manual_move(std::int_fast64_t _diff)
+    { tr.move(_diff * sizeof(IntType), _diff * (sizeof(IntType) - sizeof(key_type_t<IntType>))); }
+
+    inline std::size_t unstable(void) const
+    { return mnt.unstable(); }
+
+    // sorts [_low, _high), at most NETWORK_MAX bare keys, with a vectorized sorting network;
+    // false for records, which are left to the caller
+    template<class IntType>
+    bool network(std::size_t _low, std::size_t _high) {
+        if constexpr (!network_key_v<IntType>) return false;
+        else {
+            const std::size_t n = _high - _low;
+            if (n < 2) return true;
+            manual_access(2 * n); // loaded and stored back
+            manual_move<IntType>(n);
+            manual_comp(network_comparators(network_sort(&mnt.at<IntType>(_low), n)));
+            return true;
+        }
+    }
+
+protected:
+    // calls _self->run_<T>() with the element type of the mounted dataset
+    template<class Self>
+    void dispatch(Self* _self) {
+        visit_key_type(mnt.meta.kind, mnt.meta.bsize, mnt.meta.payload, [_self](auto _tag) {
+            _self->template run_<typename decltype(_tag)::type>();
+        });
+    }
+
+    // for methods relying on integer properties of the keys (e.g. zero as a marker)
+    template<class Self>
+    void dispatch_unsigned(Self* _self) {
+        if (mnt.meta.kind != KeyKind::UNSIGNED || mnt.meta.payload)
+            throw std::invalid_argument("Unsigned integer keys only, not " + mnt.meta.type());
+        switch (mnt.meta.bsize) {
+        case 8:  _self->template run_<std::uint8_t >(); break;
+        case 16: _self->template run_<std::uint16_t>(); break;
+        case 32: _self->template run_<std::uint32_t>(); break;
+        case 64: _self->template run_<std::uint64_t>(); break;
+        }
+    }
+
+    // cooperative cancellation: sorters poll at coarse steps (a pass, a partition, a merge, an extracted key),
+    // never per element access, so the data helpers above stay free of it
+    inline void poll() const {
+        if (mnt.cancelled.load(std::memory_order_relaxed)) [[unlikely]] throw SortCancelled();
+    }
+
 protected:
     Mount& mnt;
-    Trace tr;
+    TracePolicy tr;
 };
 
 #endif
\ No newline at end of file
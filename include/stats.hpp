@@ -0,0 +1,63 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <cmath>
+#include <cstdint>
+
+// linear interpolation between closest ranks, _sorted must be ascending and non-empty
+inline double percentile(const std::vector<double>& _sorted, double _p) {
+    double rank = _p * (_sorted.size() - 1);
+    std::size_t lo = std::size_t(rank);
+    std::size_t hi = std::min(lo + 1, _sorted.size() - 1);
+    return _sorted[lo] + (rank - lo) * (_sorted[hi] - _sorted[lo]);
+}
+
+class Summary { // order statistics and spread of per-iteration samples
+public:
+    static constexpr std::size_t RESAMPLES = 1000;
+    static constexpr double CONFIDENCE = 0.95;
+
+    Summary(std::vector<double> _samples, std::uint64_t _seed = 0) {
+        if (_samples.empty()) return;
+        std::sort(_samples.begin(), _samples.end());
+        n      = _samples.size();
+        min    = _samples.front();
+        max    = _samples.back();
+        median = percentile(_samples, 0.50);
+        p90    = percentile(_samples, 0.90);
+        p99    = percentile(_samples, 0.99);
+        mean   = std::accumulate(_samples.begin(), _samples.end(), 0.) / n;
+        double ss = 0.;
+        for (double x : _samples) ss += (x - mean) * (x - mean);
+        stddev = n > 1 ? std::sqrt(ss / (n - 1)) : 0.;
+        bootstrap(_samples, _seed);
+    }
+
+private:
+    // percentile bootstrap of the mean, seeded so reruns report the same interval
+    void bootstrap(const std::vector<double>& _samples, std::uint64_t _seed) {
+        std::mt19937_64 gen(_seed);
+        std::uniform_int_distribution<std::size_t> pick(0, n - 1);
+        std::vector<double> means(RESAMPLES);
+        for (auto& m : means) {
+            double sum = 0.;
+            for (std::size_t i = 0; i < n; ++i) sum += _samples[pick(gen)];
+            m = sum / n;
+        }
+        std::sort(means.begin(), means.end());
+        ci_low  = percentile(means, (1. - CONFIDENCE) / 2);
+        ci_high = percentile(means, (1. + CONFIDENCE) / 2);
+    }
+
+public:
+    std::size_t n = 0;
+    double min = 0., median = 0., p90 = 0., p99 = 0., max = 0.;
+    double mean = 0., stddev = 0.;
+    double ci_low = 0., ci_high = 0.; // CONFIDENCE interval of the mean
+};
+
+#endif
@@ -3,8 +3,10 @@
 
 #include <cstdint>
 
-class Trace {
+class Trace { // counting policy
 public:
+    static constexpr bool enabled = true;
+
     Trace() {}
 
     template<std::int_fast64_t Diff>
@@ -15,16 +17,109 @@ public:
     inline void comp()
     { cnt_comp += Diff; }
 
+    // counts known only at run time, charged in bulk for a whole block
+    inline void access(std::int_fast64_t _diff)
+    { cnt_access += _diff; }
+
+    inline void comp(std::int_fast64_t _diff)
+    { cnt_comp += _diff; }
+
+    inline void read(std::int_fast64_t _bytes)
+    { cnt_read += _bytes; }
+
+    inline void write(std::int_fast64_t _bytes)
+    { cnt_write += _bytes; }
+
+    // an element written to memory, _payload of its _bytes travelled along with the key
+    inline void move(std::int_fast64_t _bytes, std::int_fast64_t _payload)
+    { cnt_move += _bytes; cnt_payload += _payload; }
+
+    inline void reset()
+    { cnt_access = cnt_comp = cnt_swap = cnt_read = cnt_write = cnt_move = cnt_payload = 0; }
+
+    inline Trace& operator+=(const Trace& _other) {
+        cnt_access += _other.cnt_access;
+        cnt_comp   += _other.cnt_comp;
+        cnt_read   += _other.cnt_read;
+        cnt_write  += _other.cnt_write;
+        cnt_move   += _other.cnt_move;
+        cnt_payload += _other.cnt_payload;
+        return *this;
+    }
+
     inline std::int_fast64_t count_access() const
     { return cnt_access; }
 
     inline std::int_fast64_t count_comp() const
     { return cnt_comp; }
 
+    inline std::int_fast64_t count_io() const
+    { return cnt_read + cnt_write; }
+
+    inline std::int_fast64_t count_move() const
+    { return cnt_move; }
+
+    inline std::int_fast64_t count_payload() const
+    { return cnt_payload; }
+
 private:
     std::int_fast64_t cnt_access = 0;
     std::int_fast64_t cnt_comp = 0;
     std::int_fast64_t cnt_swap = 0;
+    std::int_fast64_t cnt_read = 0;  // bytes read back from secondary storage
+    std::int_fast64_t cnt_write = 0; // bytes spilled to secondary storage
+    std::int_fast64_t cnt_move = 0;    // bytes of elements written, keys and payloads
+    std::int_fast64_t cnt_payload = 0; // part of cnt_move spent on record payloads
+};
+
+class NullTrace { // no-op policy for wall-clock-only builds, every counter reads as zero
+public:
+    static constexpr bool enabled = false;
+
+    NullTrace() {}
+
+    template<std::int_fast64_t Diff>
+    inline void access() {}
+
+    template<std::int_fast64_t Diff>
+    inline void comp() {}
+
+    inline void access(std::int_fast64_t) {}
+
+    inline void comp(std::int_fast64_t) {}
+
+    inline void read(std::int_fast64_t) {}
+
+    inline void write(std::int_fast64_t) {}
+
+    inline void move(std::int_fast64_t, std::int_fast64_t) {}
+
+    inline void reset() {}
+
+    inline NullTrace& operator+=(const NullTrace&)
+    { return *this; }
+
+    inline std::int_fast64_t count_access() const
+    { return 0; }
+
+    inline std::int_fast64_t count_comp() const
+    { return 0; }
+
+    inline std::int_fast64_t count_io() const
+    { return 0; }
+
+    inline std::int_fast64_t count_move() const
+    { return 0; }
+
+    inline std::int_fast64_t count_payload() const
+    { return 0; }
 };
 
+// chosen at compile time, build with -DNULL_TRACE to strip the counters from every sorter
+#ifdef NULL_TRACE
+using TracePolicy = NullTrace;
+#else
+using TracePolicy = Trace;
+#endif
+
 #endif
\ No newline at end of file
@@ -1,6 +1,7 @@
 import os
 import glob
 import re
+import struct
 import numpy as np
 import matplotlib.pyplot as plt
 from tqdm import tqdm
@@ -25,6 +26,19 @@ file_list = glob.glob(os.path.join(dataset_dir, '*'))
 def output(f):
     return os.path.join(plot_dir, f'{f}.png')
 
+# include/container.hpp: magic, version, kind, rng, bsize, payload, flags, generator, size, seed, block, offset, bytes, checksum, dist, pattern
+CONTAINER_MAGIC = b'SBENCH\x1a\n'
+CONTAINER_HEADER = struct.Struct('<8sHBBHHII6Q16s16s')
+CONTAINER_COMPRESSED = 1
+
+def container(filepath):
+    with open(filepath, 'rb') as f:
+        head = f.read(CONTAINER_HEADER.size)
+    if len(head) < CONTAINER_HEADER.size or not head.startswith(CONTAINER_MAGIC):
+        return None
+    fields = CONTAINER_HEADER.unpack(head)
+    return {'flags': fields[6], 'size': fields[8], 'offset': fields[11]}
+
 targets = []
 
 for filepath in file_list:
@@ -37,7 +51,7 @@ for filepath in file_list:
     if ext not in ['sorted', 'unsorted']:
         continue
 
-    match = re.match(r'int(\d+)_(\d+[KMGT]?)_([^_]+)_([^_]+)_([^\.]+)', name_part)
+    match = re.match(r'(int|sint|float)(\d+)(?:p(\d+))?_(\d+[KMGT]?)_([^_]+)_([^_]+)_([^\.]+)', name_part)
     if not match:
         continue
 
@@ -60,8 +74,9 @@ for info in tqdm(targets, desc='Generating plots'):
     ext = info['ext']
     match = info['match']
 
-    nbits_str, size_str, dist, pattern, _ = match.groups()
+    kind, nbits_str, payload_str, size_str, dist, pattern, _ = match.groups()
     nbits = int(nbits_str)
+    payload = int(payload_str) if payload_str else 0
     if size_str.isnumeric():
         size = int(size_str)
     else:
@@ -69,10 +84,22 @@ for info in tqdm(targets, desc='Generating plots'):
         size_number = int(size_str[:-1])
         size = size_number * suffix.get(size_unit, 1)
     byte_size = nbits // 8
-    dtype = np.dtype(f'<u{byte_size}')  # little endian
+    code = {'int': 'u', 'sint': 'i', 'float': 'f'}[kind]
+    dtype = np.dtype([('key', f'<{code}{byte_size}'), ('payload', f'V{payload}')] if payload else f'<{code}{byte_size}')  # little endian, records keep the key only
+
+    offset = 0
+    header = container(filepath)
+    if header:
+        if header['flags'] & CONTAINER_COMPRESSED:
+            tqdm.write(f'Skipping {filename}: compressed container')
+            continue
+        size, offset = header['size'], header['offset']
 
     with open(filepath, 'rb') as f:
-        data = np.frombuffer(f.read(size * byte_size), dtype=dtype)
+        f.seek(offset)
+        data = np.frombuffer(f.read(size * dtype.itemsize), dtype=dtype)
+    if payload:
+        data = data['key']
 
     x = np.arange(size)
     y = data
@@ -80,7 +107,12 @@ for info in tqdm(targets, desc='Generating plots'):
     plt.figure(figsize=(8, 6))
     plt.scatter(x, y, s=1, c='black')
     plt.xlim(0, size)
-    plt.ylim(0, 2**nbits)
+    if kind == 'int':
+        plt.ylim(0, 2**nbits)
+    elif kind == 'sint':
+        plt.ylim(-2**(nbits - 1), 2**(nbits - 1))
+    else:
+        plt.ylim(-1, 1)
     plt.xlabel('Index', fontsize=15)
     plt.ylabel('Data', fontsize=15)
     plt.title(f'{dist}_{pattern} ({ext})', fontsize=17, pad=15)
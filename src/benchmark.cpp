@@ -1,11 +1,23 @@
 #include <iostream>
 #include <cstdint>
+#include <glob.h>
+#include <sched.h>
+#include <mutex>
+#include <sstream>
+#include <map>
+#include <set>
+#include <tuple>
+#include <optional>
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
 
 #include "argparse.hpp"
 #include "filesys.hpp"
 #include "sort.hpp"
 #include "benchmark.hpp"
 #include "verbose.hpp"
+#include "stats.hpp"
+#include "fit.hpp"
 
 using ClockResolution = std::milli;
 
@@ -17,120 +29,547 @@ int check_width(const T& _data, int _precision = -1) {
     return ss.str().size();
 }
 
-int main(int argc, char** argv) {
-    argparse::ArgumentParser args("benchmark");
-    args.add_argument("--method")
-        .required()
-        .choices("merge", "heap", "bubble", "insertion", "selection", "quick", "quick_mid", "library", "tim", "cocktail", "comb", "tournament", "introsort");
-    
-    args.add_argument("--iteration")
-        .scan<'i', std::int16_t>()
-        .default_value((std::int16_t)10);
-    
-    args.add_argument("--verbose")
-        .default_value(false)
-        .implicit_value(true);
+struct BenchConfig { // options shared by every (dataset, method) pair
+    std::int16_t iter;
+    std::int16_t warmup;
+    bool verbose;
+    std::size_t run_size;
+    std::size_t threads;
+    bool scheduled; // jobs share the process, so counters and logs must stay per job
+    std::chrono::duration<double> budget; // per run(), zero for none
+    SmallSort small_sort; // base case of introsort, tim and vector_quick
+};
 
-    args.add_argument("--dataset")
-        .required();
-    
-    args.add_argument("--result")
-        .default_value("./benchmark_result.csv");
-    
-    try { args.parse_args(argc, argv); }
-    catch (const std::exception& err) {
-        std::cerr << err.what() << std::endl;
-        std::cerr << args;
-        std::exit(1);
+struct BenchSummary { // what the extrapolation fits on
+    double n;
+    double mean_duration;
+    double mean_access;
+    double mean_comp;
+    bool timeout;
+};
+
+std::unique_ptr<SortBase> make_sort(const std::string& method, Mount& mnt, const BenchConfig& cfg) {
+    if (method == "bubble")     return std::make_unique<Bubble    >(mnt);
+    if (method == "selection")  return std::make_unique<Selection >(mnt);
+    if (method == "insertion")  return std::make_unique<Insertion >(mnt);
+    if (method == "merge")      return std::make_unique<Merge     >(mnt);
+    if (method == "heap")       return std::make_unique<Heap      >(mnt);
+    if (method == "quick")      return std::make_unique<Quick     >(mnt);
+    if (method == "quick_mid")  return std::make_unique<QuickMid  >(mnt);
+    if (method == "library")    return std::make_unique<Library   >(mnt);
+    if (method == "tim")        return std::make_unique<Tim       >(mnt, cfg.small_sort);
+    if (method == "cocktail")   return std::make_unique<Cocktail  >(mnt);
+    if (method == "comb")       return std::make_unique<Comb      >(mnt);
+    if (method == "tournament") return std::make_unique<Tournament>(mnt);
+    if (method == "introsort")  return std::make_unique<Introsort>(mnt, cfg.small_sort);
+    if (method == "external")   return std::make_unique<External  >(mnt, cfg.run_size);
+    if (method == "radix_lsd8") return std::make_unique<RadixLSD<8> >(mnt);
+    if (method == "radix_lsd11") return std::make_unique<RadixLSD<11>>(mnt);
+    if (method == "radix_msd")  return std::make_unique<RadixMSD  >(mnt);
+    if (method == "parallel_sample") return std::make_unique<ParallelSample>(mnt, cfg.threads);
+    if (method == "parallel_merge")  return std::make_unique<ParallelMerge >(mnt, cfg.threads);
+    if (method == "parallel_introsort") return std::make_unique<ParallelIntrosort>(mnt, cfg.threads);
+    if (method == "block_quick") return std::make_unique<BlockQuick>(mnt);
+    if (method == "pdq")        return std::make_unique<PatternDefeating>(mnt);
+    if (method == "network")    return std::make_unique<Network   >(mnt);
+    if (method == "vector_quick") return std::make_unique<VectorQuick>(mnt, cfg.small_sort);
+    throw std::runtime_error("Unsupported sorting metod: " + method);
+}
+
+// out-of-core methods stream the dataset from disk themselves, the others sort a resident copy
+bool out_of_core(const std::string& method) {
+    return method == "external";
+}
+
+// the dataset as _method takes it: a streaming Mount of its own for an out-of-core method,
+// otherwise _resident, read on first use and restored in place between methods
+Mount& mount_for(const std::string& method, const std::string& dataset, std::unique_ptr<Mount>& resident,
+                 std::unique_ptr<Mount>& streamed, bool mapped, Verify verify) {
+    if (out_of_core(method)) {
+        streamed = std::make_unique<Mount>(dataset + ".unsorted", mapped, verify, false);
+        return *streamed;
     }
+    if (!resident) resident = std::make_unique<Mount>(dataset + ".unsorted", mapped, verify);
+    return *resident;
+}
 
-    std::ofstream result_csv(args.get<std::string>("--result"), std::ios::app);
-    const std::string method = args.get<std::string>("--method");
-    const std::string dataset = args.get<std::string>("--dataset");
-    const std::int16_t iter = args.get<std::int16_t>("--iteration");
-    const bool verbose = args.get<bool>("--verbose");
+// directories and glob patterns expand to every dataset they hold, paths are returned without the .unsorted suffix
+std::vector<std::string> expand_datasets(const std::vector<std::string>& _entries) {
+    const std::string suffix = ".unsorted";
+    auto strip = [&](std::string _path) {
+        if (_path.ends_with(suffix)) _path.resize(_path.size() - suffix.size());
+        return _path;
+    };
+    std::vector<std::string> datasets;
+    for (const auto& entry : _entries) {
+        std::vector<std::string> found;
+        if (std::filesystem::is_directory(entry)) {
+            for (const auto& file : std::filesystem::directory_iterator(entry))
+                if (file.path().extension() == suffix) found.push_back(strip(file.path().string()));
+        }
+        else if (std::filesystem::exists(strip(entry) + suffix)) {
+            found.push_back(strip(entry));
+        }
+        else {
+            glob_t matches;
+            if (glob(entry.c_str(), 0, nullptr, &matches) == 0)
+                for (std::size_t i = 0; i < matches.gl_pathc; ++i)
+                    if (std::string(matches.gl_pathv[i]).ends_with(suffix)) found.push_back(strip(matches.gl_pathv[i]));
+            globfree(&matches);
+            if (found.empty()) throw std::runtime_error("No dataset matches: " + entry);
+        }
+        std::sort(found.begin(), found.end());
+        datasets.insert(datasets.end(), found.begin(), found.end());
+    }
+    return datasets;
+}
 
-    if (!result_csv) throw std::runtime_error("Cannot open the file: " + args.get<std::string>("--result"));
+// cpus this process may run on, in ascending order
+std::vector<int> allowed_cpus() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    std::vector<int> cpus;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        for (int c = 0; c < CPU_SETSIZE; ++c) if (CPU_ISSET(c, &set)) cpus.push_back(c);
+    if (cpus.empty()) cpus.push_back(0);
+    return cpus;
+}
+
+// pins the calling thread, threads it spawns afterwards inherit the mask
+void pin_thread(const std::vector<int>& _cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : _cpus) CPU_SET(c, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0)
+        throw std::runtime_error("Cannot pin the benchmark thread");
+}
 
-    if (verbose) std::cout << std::fixed << std::setprecision(3);
+// runs one method on an already mounted dataset and appends its row to the results
+BenchSummary bench(Mount& mnt, const std::string& dataset, const std::string& method, const BenchConfig& cfg,
+           std::ofstream& result_csv, std::ofstream& raw_csv, std::mutex& csv_mtx, std::ostream& out) {
+    const std::int16_t iter = cfg.iter;
+    const std::int16_t warmup = cfg.warmup;
+    const bool verbose = cfg.verbose;
+
+    if (verbose) out << std::fixed << std::setprecision(3);
 
     if (verbose) {
-        std::cout << "================= BENCHMARK INFO =================\n"
-                  << "      Test Data : " << std::filesystem::path(dataset).filename().string() << "\n"
-                  << " Sorting Method : " << method  << "\n"
-                  << "      Iteration : " << iter << "\n"
-                  << "==================================================\n";
-    }
-
-    Mount mnt(dataset + ".unsorted");
-    std::unique_ptr<SortBase> sort = [&]() -> std::unique_ptr<SortBase> {
-        if (method == "bubble")     return std::make_unique<Bubble    >(mnt);
-        if (method == "selection")  return std::make_unique<Selection >(mnt);
-        if (method == "insertion")  return std::make_unique<Insertion >(mnt);
-        if (method == "merge")      return std::make_unique<Merge     >(mnt);
-        if (method == "heap")       return std::make_unique<Heap      >(mnt);
-        if (method == "quick")      return std::make_unique<Quick     >(mnt);
-        if (method == "quick_mid")  return std::make_unique<QuickMid  >(mnt);
-        if (method == "library")    return std::make_unique<Library   >(mnt);
-        if (method == "tim")        return std::make_unique<Tim       >(mnt);
-        if (method == "cocktail")   return std::make_unique<Cocktail  >(mnt);
-        if (method == "comb")       return std::make_unique<Comb      >(mnt);
-        if (method == "tournament") return std::make_unique<Tournament>(mnt);
-        if (method == "introsort")  return std::make_unique<Introsort>(mnt);
-        throw std::runtime_error("Unsupported sorting metod: " + method);
-    }();
+        out << "================= BENCHMARK INFO =================\n"
+            << "      Test Data : " << std::filesystem::path(dataset).filename().string() << "\n"
+            << "       Key Type : " << mnt.meta.type() << "\n"
+            << "   Verification : " << (mnt.fingerprinted() ? "fingerprint" : "answer") << "\n"
+            << "        Storage : " << (!mnt.meta.container ? "raw" : mnt.meta.container->compressed() ? "compressed container" : "container") << "\n"
+            << " Sorting Method : " << method  << "\n";
+        if (method == "network" || (cfg.small_sort == SmallSort::NETWORK && (method == "introsort" || method == "tim" || method == "vector_quick")))
+            out << " Network Kernel : " << network_isa_name(network_isa()) << "\n";
+        if (method == "vector_quick")
+            out << "      Partition : " << (mnt.meta.type() == "int32" || mnt.meta.type() == "int64" // unsigned bare keys
+                                            ? partition_isa_name(partition_isa()) : "scalar") << "\n";
+        out << "      Iteration : " << iter << "\n"
+            << "        Warm-up : " << warmup << "\n"
+            << "==================================================\n";
+    }
+
+    std::unique_ptr<SortBase> sort = make_sort(method, mnt, cfg);
 
     TimeLapse<std::ratio<1>> lapse([](double dur) {
         return std::format("[{:>9.3f}] ", dur);
     });
     if (verbose) lapse.start();
-    if (verbose) std::cout << lapse() << "Started\n";
+    if (verbose) out << lapse() << "Started\n";
+
+    PerfGroup perf(!cfg.scheduled); // opened after the sorter so worker pools are already running
+    // a scheduler job counts its own thread only, which would leave out the workers of a parallel sorter
+    const bool partial = cfg.scheduled && sort->threads() > 1;
+    if (verbose && !perf.available()) out << lapse() << "Hardware counters unavailable (perf_event_open not permitted)\n";
+    else if (verbose && partial) out << lapse() << "Hardware counters left blank (workers are not counted under --jobs)\n";
 
     std::vector<BenchResult<ClockResolution>> result;
 
     int w_iter = check_width(iter);
 
-    for (std::int64_t i = 0; i < iter; ++i) {
-        if (verbose) std::cout << lapse() << "Iteration " << std::setw(w_iter) << i+1 << " / " << iter << std::flush;
-        auto bres = benchmark<ClockResolution>(sort);
-        if (verbose) std::cout << " => " << bres.duration.count() << " ms\n";
+    // a run over the time budget is recorded as censored and ends the measurement, later runs would time out as well
+    bool timeout = false;
+    for (std::int64_t i = 0; i < warmup && !timeout; ++i) {
+        if (verbose) out << lapse() << "Warm-up   " << std::setw(w_iter) << i+1 << " / " << warmup << std::flush;
+        auto bres = benchmark<ClockResolution>(sort, perf, cfg.budget);
+        if (verbose) out << " => " << bres.duration.count() << (bres.timeout ? " ms (timed out)\n" : " ms\n");
+        if ((timeout = bres.timeout)) result.push_back(bres);
+        mnt.reset();
+    }
+
+    for (std::int64_t i = 0; i < iter && !timeout; ++i) {
+        if (verbose) out << lapse() << "Iteration " << std::setw(w_iter) << i+1 << " / " << iter << std::flush;
+        auto bres = benchmark<ClockResolution>(sort, perf, cfg.budget);
+        if (verbose) out << " => " << bres.duration.count() << (bres.timeout ? " ms (timed out)\n" : " ms\n");
+        timeout = bres.timeout;
         result.push_back(bres);
         mnt.reset();
     }
-    if (verbose) std::cout << lapse() << "Finished\n";
+    if (verbose) out << lapse() << "Finished\n";
     
+    const double runs = result.size();
     double total_duration = 0., mean_duration = 0.;
-    double mean_access = 0., mean_comp = 0;
+    double mean_access = 0., mean_comp = 0, mean_io = 0., mean_move = 0., mean_payload = 0.;
+    std::size_t unstable = 0;
+    std::array<double, PERF_EVENTS> mean_perf = {};
     for (auto bres : result) {
         total_duration += bres.duration.count();
-        mean_access    += double(bres.trace.count_access()) / iter;
-        mean_comp      += double(bres.trace.count_comp  ()) / iter;
+        for (std::size_t e = 0; e < PERF_EVENTS; ++e)
+            mean_perf[e] += double(bres.perf.values[e]) / runs;
+        mean_access    += double(bres.trace.count_access()) / runs;
+        mean_comp      += double(bres.trace.count_comp  ()) / runs;
+        mean_io        += double(bres.trace.count_io    ()) / runs;
+        mean_move      += double(bres.trace.count_move   ()) / runs;
+        mean_payload   += double(bres.trace.count_payload()) / runs;
+        unstable = std::max(unstable, bres.unstable);
     }
-    mean_duration = total_duration / iter;
+    const double n = mnt.meta.size;
+    mean_duration = total_duration / runs;
+
+    std::vector<double> durations;
+    for (const auto& bres : result) durations.push_back(bres.duration.count());
+    Summary stats(durations);
 
     if (verbose) {
         int w_dur = check_width(total_duration, 3);
-        int m_dur = check_width(std::max({mean_access, mean_comp}), 0);
-        std::cout << "================ BENCHMARK RESULT ================\n"
-                  << "     Input Size (N) : " << mnt.meta.size << "\n"
-                  << " Total Elapsed Time : " << total_duration << " ms\n"
-                  << "  Mean Elapsed Time : " << std::setw(w_dur) << mean_duration << " ms\n"
-                  << std::setprecision(0)
-                  << "   # Array Accesses : " << std::setw(m_dur) << mean_access << ". / iteration\n"
-                  << "      # Comparisons : " << std::setw(m_dur) << mean_comp << ". / iteration\n"
-                  << "==================================================\n";
-    }
-
-    // timestamp,method,N,int_size,distribution,pattern,iteration,mean_elapsed,#(array accesses),#(comparisons)
+        int m_dur = check_width(std::max({mean_access, mean_comp, mean_io}), 0);
+        out << "================ BENCHMARK RESULT ================\n"
+            << "     Input Size (N) : " << mnt.meta.size << "\n"
+            << "            Threads : " << sort->threads() << "\n"
+            << " Total Elapsed Time : " << total_duration << " ms\n"
+            << "  Mean Elapsed Time : " << std::setw(w_dur) << mean_duration << " ms\n"
+            << " Min / Median / Max : " << stats.min << " / " << stats.median << " / " << stats.max << " ms\n"
+            << "          p90 / p99 : " << stats.p90 << " / " << stats.p99 << " ms\n"
+            << "     Std. Deviation : " << stats.stddev << " ms\n"
+            << "      95% CI (mean) : [" << stats.ci_low << ", " << stats.ci_high << "] ms\n"
+            << "          Timed Out : " << (timeout ? "yes, censored" : "no") << "\n"
+            << std::setprecision(0);
+        if (TracePolicy::enabled) {
+            out << "   # Array Accesses : " << std::setw(m_dur) << mean_access << ". / iteration\n"
+                << "      # Comparisons : " << std::setw(m_dur) << mean_comp << ". / iteration\n"
+                << "        # I/O Bytes : " << std::setw(m_dur) << mean_io << ". / iteration\n"
+                << std::setprecision(3)
+                << " Bytes Moved / Elem : " << mean_move / n << "\n"
+                << "   of which Payload : " << mean_payload / n << "\n"
+                << std::setprecision(0);
+        }
+        if (mnt.meta.payload)
+            out << "     Unstable Pairs : " << unstable << (unstable ? "\n" : " (stable)\n");
+        if (perf.available() && !partial) {
+            // per element, so methods can be compared across input sizes
+            out << std::setprecision(3)
+                << "   Cycles / Element : " << mean_perf[PERF_CYCLES] / n << "\n"
+                << "    Instr / Element : " << mean_perf[PERF_INSTRUCTIONS] / n << "\n"
+                << "   Cache Misses / E : " << mean_perf[PERF_CACHE_MISSES] / n << "\n"
+                << "  Branch Misses / E : " << mean_perf[PERF_BRANCH_MISSES] / n << "\n";
+        }
+        out << "==================================================\n";
+    }
+
+    // operation counts are left blank by the timing build (NullTrace)
+    auto count = [](double _mean) -> std::string {
+        return TracePolicy::enabled ? std::format("{:.0f}.", _mean) : std::string();
+    };
+    auto per_element = [&](double _mean) -> std::string {
+        return TracePolicy::enabled ? std::format("{:.3f}", _mean / n) : std::string();
+    };
+    // hardware counters are left blank where perf_event_open is not permitted or they would miss the workers
+    auto counter = [&](PerfEvent _event) -> std::string {
+        return !partial && !result.empty() && result.front().perf.available(_event) ? std::format("{:.0f}", mean_perf[_event]) : std::string();
+    };
+
+    std::lock_guard<std::mutex> lock(csv_mtx); // jobs of the scheduler share both files
+
+    // timestamp,method,N,int_size,distribution,pattern,iteration,mean_elapsed,#(array accesses),#(comparisons),#(I/O bytes),threads,cycles,instructions,cache misses,branch misses,min,median,p90,p99,max,stddev,ci low,ci high,timeout,key type,bytes moved/elem,payload bytes/elem,stability violations
     csv_write_row(result_csv, timestamp(),
                               method,
                               mnt.meta.size,
                               mnt.meta.bsize,
                               mnt.meta.dist,
                               mnt.meta.pattern,
-                              iter,
+                              result.size(),
                               std::format("{:.3f}", mean_duration),
-                              std::format("{:.0f}.", mean_access),
-                              std::format("{:.0f}.", mean_comp));
+                              count(mean_access),
+                              count(mean_comp),
+                              count(mean_io),
+                              sort->threads(),
+                              counter(PERF_CYCLES),
+                              counter(PERF_INSTRUCTIONS),
+                              counter(PERF_CACHE_MISSES),
+                              counter(PERF_BRANCH_MISSES),
+                              std::format("{:.3f}", stats.min),
+                              std::format("{:.3f}", stats.median),
+                              std::format("{:.3f}", stats.p90),
+                              std::format("{:.3f}", stats.p99),
+                              std::format("{:.3f}", stats.max),
+                              std::format("{:.3f}", stats.stddev),
+                              std::format("{:.3f}", stats.ci_low),
+                              std::format("{:.3f}", stats.ci_high),
+                              int(timeout),
+                              mnt.meta.type(),
+                              per_element(mean_move),
+                              per_element(mean_payload),
+                              mnt.meta.payload ? std::to_string(unstable) : std::string()); // blank for bare keys
+
+    if (raw_csv.is_open()) {
+        // timestamp,method,N,int_size,distribution,pattern,iteration index,elapsed
+        for (std::size_t i = 0; i < result.size(); ++i)
+            csv_write_row(raw_csv, timestamp(),
+                                   method,
+                                   mnt.meta.size,
+                                   mnt.meta.bsize,
+                                   mnt.meta.dist,
+                                   mnt.meta.pattern,
+                                   i + 1,
+                                   std::format("{:.3f}", result[i].duration.count()));
+        raw_csv.flush();
+    }
+    result_csv.flush(); // rows already written survive a later pair that aborts the run
+    return { double(mnt.meta.size), mean_duration, mean_access, mean_comp, timeout };
+}
+
+// bench() for one (method, dataset) pair of a larger run: a method that rejects the element type, e.g. library
+// on signed keys or records, is skipped and the remaining pairs still run
+std::optional<BenchSummary> bench_or_skip(Mount& mnt, const std::string& dataset, const std::string& method, const BenchConfig& cfg,
+                                          std::ofstream& result_csv, std::ofstream& raw_csv, std::mutex& csv_mtx, std::ostream& out) {
+    try {
+        return bench(mnt, dataset, method, cfg, result_csv, raw_csv, csv_mtx, out);
+    }
+    catch (const std::invalid_argument& err) {
+        mnt.reset(); // the next method gets the input as it was
+        out << "Skipped " << method << " on " << std::filesystem::path(dataset).filename().string() << ": " << err.what() << std::endl;
+        return std::nullopt;
+    }
+}
+
+// runs every method up the ladder of datasets no larger than _fit_max and predicts its cost at _target;
+// datasets of another key type, distribution or pattern form ladders of their own, each fitted separately
+void extrapolate(const std::vector<std::string>& methods, const std::vector<std::string>& datasets,
+                 std::size_t _target, std::size_t _fit_max, bool _mapped, Verify _verify, const BenchConfig& cfg,
+                 std::ofstream& result_csv, std::ofstream& raw_csv, std::ofstream& fit_csv) {
+    using Series = std::tuple<std::string, std::string, std::string>; // key type, distribution, pattern
+    std::map<Series, std::vector<std::pair<std::size_t, std::string>>> ladders;
+    for (const auto& dataset : datasets) {
+        Metadata meta(dataset + ".unsorted");
+        if (meta.size <= _fit_max) ladders[{meta.type(), meta.dist, meta.pattern}].emplace_back(meta.size, dataset);
+    }
+    if (ladders.empty()) throw std::runtime_error("No dataset within the fit range");
+
+    std::mutex csv_mtx;
+    for (auto& [series, ladder] : ladders) {
+        std::sort(ladder.begin(), ladder.end());
+
+        // a method stops climbing at its first censored run, larger sizes would only time out again;
+        // one that rejects the element type is skipped for the whole ladder
+        std::map<std::string, std::vector<BenchSummary>> points;
+        std::set<std::string> stopped, skipped;
+        for (const auto& [n, dataset] : ladder) {
+            std::unique_ptr<Mount> resident, streamed;
+            for (const auto& method : methods) {
+                if (stopped.count(method)) continue;
+                Mount& mnt = mount_for(method, dataset, resident, streamed, _mapped, _verify);
+                std::optional<BenchSummary> summary = bench_or_skip(mnt, dataset, method, cfg, result_csv, raw_csv, csv_mtx, std::cout);
+                if (!summary) skipped.insert(method);
+                if (!summary || summary->timeout) stopped.insert(method);
+                else points[method].push_back(*summary);
+            }
+        }
+
+        const auto& [type, dist, pattern] = series;
+        Metadata meta(ladder.front().second + ".unsorted");
+        std::cout << std::fixed << std::setprecision(3)
+                  << "================== EXTRAPOLATION =================\n"
+                  << "         Series : " << type << " " << dist << " " << pattern << "\n"
+                  << "       Target N : " << _target << "\n"
+                  << "      Fit Range : N <= " << _fit_max << ", a * N^b * (ln N)^c\n";
+        for (const auto& method : methods) {
+            const auto& pts = points[method];
+            std::cout << "--------------------------------------------------\n"
+                      << " Sorting Method : " << method;
+            if (skipped.count(method)) {
+                std::cout << " (skipped, unsupported key type)\n";
+                continue;
+            }
+            std::cout << " (" << pts.size() << " sizes" << (stopped.count(method) ? ", censored above" : "") << ")\n";
+            auto fit = [&](const std::string& metric, double BenchSummary::* field, const std::string& unit, int precision) {
+                std::vector<double> ns, ys;
+                for (const auto& pt : pts) { ns.push_back(pt.n); ys.push_back(pt.*field); }
+                try {
+                    CostModel model(ns, ys);
+                    Prediction p = model.predict(_target);
+                    std::cout << std::setw(15) << metric << " : " << std::setprecision(precision) << p.value << unit
+                              << " [" << p.low << ", " << p.high << "]" << std::setprecision(3)
+                              << "  (b = " << model.b() << ", c = " << model.c() << ")\n";
+                    // timestamp,method,bits,distribution,pattern,points,fit max,target N,metric,a,b,c,predicted,low,high
+                    csv_write_row(fit_csv, timestamp(), method, meta.bsize, dist, pattern, model.points(), _fit_max, _target, metric,
+                                  std::format("{:.6g}", model.a()), std::format("{:.4f}", model.b()), std::format("{:.4f}", model.c()),
+                                  std::format("{:.6g}", p.value), std::format("{:.6g}", p.low), std::format("{:.6g}", p.high));
+                }
+                catch (const std::exception& err) {
+                    std::cout << std::setw(15) << metric << " : " << err.what() << "\n";
+                }
+            };
+            fit("time", &BenchSummary::mean_duration, " ms", 3);
+            if (TracePolicy::enabled) {
+                fit("accesses", &BenchSummary::mean_access, "", 0);
+                fit("comparisons", &BenchSummary::mean_comp, "", 0);
+            }
+        }
+        std::cout << "==================================================\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    argparse::ArgumentParser args("benchmark");
+    args.add_argument("--method") // one or more, every method runs on every dataset
+        .required()
+        .nargs(argparse::nargs_pattern::at_least_one)
+        .choices("merge", "heap", "bubble", "insertion", "selection", "quick", "quick_mid", "library", "tim", "cocktail", "comb", "tournament", "introsort", "external", "radix_lsd8", "radix_lsd11", "radix_msd", "parallel_sample", "parallel_merge", "parallel_introsort", "block_quick", "pdq", "network", "vector_quick");
+    
+    args.add_argument("--iteration")
+        .scan<'i', std::int16_t>()
+        .default_value((std::int16_t)10);
+    
+    args.add_argument("--warmup") // iterations run before measuring, excluded from the statistics
+        .scan<'i', std::int16_t>()
+        .default_value((std::int16_t)0);
+
+    args.add_argument("--verbose")
+        .default_value(false)
+        .implicit_value(true);
+
+    args.add_argument("--dataset") // dataset paths, directories or glob patterns
+        .required()
+        .nargs(argparse::nargs_pattern::at_least_one);
+
+    args.add_argument("--threads") // workers of the parallel methods
+        .scan<'i', std::int16_t>()
+        .default_value((std::int16_t)std::thread::hardware_concurrency());
+
+    args.add_argument("--run-size") // #elements per in-memory run of the external sort
+        .default_value(std::string("1M"));
+
+    args.add_argument("--small-sort") // base case of introsort, tim and vector_quick, network: vectorized sorting network (bare keys)
+        .choices("insertion", "network")
+        .default_value(std::string("insertion"));
+
+    args.add_argument("--time-budget") // seconds per run(), a run over budget is cancelled and recorded as censored
+        .scan<'g', double>()
+        .default_value(0.);
+
+    args.add_argument("--jobs") // (dataset, method) jobs run concurrently, each pinned to its own cores
+        .scan<'i', std::int16_t>()
+        .default_value((std::int16_t)1);
+
+    args.add_argument("--numa-local") // scheduler jobs allocate their working copy on the node they are pinned to
+        .default_value(false)
+        .implicit_value(true);
+
+    args.add_argument("--mmap")
+        .default_value(false)
+        .implicit_value(true);
+    
+    args.add_argument("--verify") // answer: .sorted file, fingerprint: sortedness + .fingerprint sidecar, auto: answer if present
+        .choices("auto", "answer", "fingerprint")
+        .default_value(std::string("auto"));
+
+    args.add_argument("--result")
+        .default_value("./benchmark_result.csv");
+
+    args.add_argument("--raw") // optional csv receiving one row per measured iteration
+        .default_value(std::string());
+
+    args.add_argument("--extrapolate") // target N, fits the datasets up to --fit-max and predicts the cost there
+        .default_value(std::string());
+
+    args.add_argument("--fit-max") // largest dataset the extrapolation actually runs
+        .default_value(std::string("64K"));
+
+    args.add_argument("--fit-result")
+        .default_value("./benchmark_fit.csv");
+    
+    try { args.parse_args(argc, argv); }
+    catch (const std::exception& err) {
+        std::cerr << err.what() << std::endl;
+        std::cerr << args;
+        std::exit(1);
+    }
+
+    std::ofstream result_csv(args.get<std::string>("--result"), std::ios::app);
+    const std::vector<std::string> methods = args.get<std::vector<std::string>>("--method");
+    const std::vector<std::string> datasets = expand_datasets(args.get<std::vector<std::string>>("--dataset"));
+    const std::string raw = args.get<std::string>("--raw");
+    const bool mapped = args.get<bool>("--mmap");
+    const std::string verify_mode = args.get<std::string>("--verify");
+    const Verify verify = verify_mode == "answer"      ? Verify::ANSWER
+                        : verify_mode == "fingerprint" ? Verify::FINGERPRINT
+                        :                                Verify::AUTO;
+    const std::size_t jobs = std::max<std::int16_t>(args.get<std::int16_t>("--jobs"), 1);
+    const bool numa_local = args.get<bool>("--numa-local");
+    const BenchConfig cfg = {
+        args.get<std::int16_t>("--iteration"),
+        std::max<std::int16_t>(args.get<std::int16_t>("--warmup"), 0),
+        args.get<bool>("--verbose"),
+        parse_suffix(args.get<std::string>("--run-size")),
+        std::size_t(std::max<std::int16_t>(args.get<std::int16_t>("--threads"), 1)),
+        jobs > 1,
+        std::chrono::duration<double>(std::max(args.get<double>("--time-budget"), 0.)),
+        args.get<std::string>("--small-sort") == "network" ? SmallSort::NETWORK : SmallSort::INSERTION
+    };
+
+    if (!result_csv) throw std::runtime_error("Cannot open the file: " + args.get<std::string>("--result"));
+    std::ofstream raw_csv;
+    if (!raw.empty()) {
+        raw_csv.open(raw, std::ios::app);
+        if (!raw_csv) throw std::runtime_error("Cannot open the file: " + raw);
+    }
+
+    if (!args.get<std::string>("--extrapolate").empty()) {
+        std::ofstream fit_csv(args.get<std::string>("--fit-result"), std::ios::app);
+        if (!fit_csv) throw std::runtime_error("Cannot open the file: " + args.get<std::string>("--fit-result"));
+        extrapolate(methods, datasets, parse_suffix(args.get<std::string>("--extrapolate")), parse_suffix(args.get<std::string>("--fit-max")),
+                    mapped, verify, cfg, result_csv, raw_csv, fit_csv);
+        return 0;
+    }
+
+    std::mutex csv_mtx;
+
+    // each dataset is read once and restored in place between methods
+    if (jobs == 1) {
+        for (const auto& dataset : datasets) {
+            std::unique_ptr<Mount> resident, streamed;
+            for (const auto& method : methods)
+                bench_or_skip(mount_for(method, dataset, resident, streamed, mapped, verify), dataset, method, cfg, result_csv, raw_csv, csv_mtx, std::cout);
+        }
+        return 0;
+    }
+
+    // scheduler: every (dataset, method) pair is a job with a private Mount, worker w owns a disjoint slice of the cpus
+    const std::vector<int> cpus = allowed_cpus();
+    if (jobs > cpus.size())
+        throw std::runtime_error("--jobs=" + std::to_string(jobs) + " exceeds the " + std::to_string(cpus.size()) + " cpus available, slices would overlap");
+    const std::size_t width = cpus.size() / jobs;
+    BenchConfig job_cfg = cfg;
+    job_cfg.threads = std::min(cfg.threads, width); // parallel sorters stay within their slice
+    std::mutex log_mtx;
+    ThreadPool pool(jobs);
+    for (const auto& dataset : datasets) {
+        for (const auto& method : methods) {
+            pool.submit([&, dataset, method](std::size_t w) {
+                std::vector<int> slice;
+                for (std::size_t k = 0; k < width; ++k) slice.push_back(cpus[w * width + k]);
+                pin_thread(slice);
+                // the default policy already allocates on first touch, MPOL_LOCAL also overrides an inherited interleave
+                if (numa_local) syscall(SYS_set_mempolicy, MPOL_LOCAL, nullptr, 0);
+                Mount mnt(dataset + ".unsorted", mapped, verify, !out_of_core(method)); // touched here, so its pages land next to the pinned cores
+                std::ostringstream log;
+                bench_or_skip(mnt, dataset, method, job_cfg, result_csv, raw_csv, csv_mtx, log);
+                std::lock_guard<std::mutex> lock(log_mtx);
+                std::cout << log.str() << std::flush;
+            });
+        }
+    }
+    pool.wait();
     return 0;
 }
\ No newline at end of file
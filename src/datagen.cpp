@@ -6,9 +6,17 @@
 #include <cmath>
 #include <random>
 #include <exception>
+#include <cstring>
+#include <type_traits>
+#include <queue>
+#include <thread>
 
 #include "argparse.hpp"
 #include "filesys.hpp"
+#include "parallel.hpp"
+#include "philox.hpp"
+
+constexpr std::uint32_t GENERATOR_VERSION = 1; // stored in containers, bumped whenever a seed would yield other data
 
 inline double NlogN(std::size_t N)
 { double n = static_cast<double>(N); return n * std::log2(n); }
@@ -19,7 +27,8 @@ void swap(std::mt19937& engine, std::vector<T>& list, std::size_t begin, std::si
     std::swap(list[dist(engine)], list[dist(engine)]);
 }
 
-inline bool coin_flip(std::mt19937& engine)
+template<class Engine>
+inline bool coin_flip(Engine& engine)
 { return engine() % 2; }
 
 template<class T>
@@ -43,91 +52,88 @@ void reverse_merge(std::mt19937& engine, std::vector<T>& list, std::size_t depth
     reverse_merge(engine, list, depth - 1, mid, high);
 }
 
+// named key distribution, the setup draws (constant, fewunique) are taken from the engine passed at construction;
+// a copy continues independently, so every generator block can start from the same prototype
 template<class IntType>
-void generate(const std::size_t& iter,
-              const std::string& dist,
-              const std::string& pattern,
-              std::mt19937& engine,
-              const std::string& dest,
-              bool verbose=false) {
-    std::function<IntType()> distgen;
-    bool randomly_generated = true;
+class Distribution {
+private:
+    enum Shape { UNIFORM, NORMAL, BIMODAL, EXPONENTIAL, CONSTANT, FEWUNIQUE };
+
+    static Shape parse(const std::string& _dist) {
+        if (_dist == "uniform")     return UNIFORM;
+        if (_dist == "normal")      return NORMAL;
+        if (_dist == "bimodal")     return BIMODAL;
+        if (_dist == "exponential") return EXPONENTIAL;
+        if (_dist == "constant")    return CONSTANT;
+        if (_dist == "fewunique")   return FEWUNIQUE;
+        throw std::runtime_error("Unsupported distribution: " + _dist);
+    }
 
-    if (dist == "uniform") {
-        // debug log: uniform_dist is a local instance, lambda captures dangling reference of uniform_dist, resulting to UB
-        // (1) static std::uniform_int_distribution<IntType> uniform_dist <= ***given that generate() is called only once!***
-        // (2) [uniform_dist, &engine] <= explicit capture
-        static std::uniform_int_distribution<IntType> uniform_dist(std::numeric_limits<IntType>::min(), std::numeric_limits<IntType>::max());
-        distgen = [&]() -> IntType {
-            return uniform_dist(engine);
-        };
-    } else if (dist == "normal") {
-        double mu = (std::numeric_limits<IntType>::max() + std::numeric_limits<IntType>::min()) / 2.;
-        double sd = ((std::numeric_limits<IntType>::max() >> 1) / 4.) - ((std::numeric_limits<IntType>::min() >> 1) / 4.); // 4sigma ~ 99.994%
-        static std::normal_distribution<double> normal_dist(mu, sd);
-        distgen = [&]() -> IntType {
-            double x;
-            double dmin = static_cast<double>(std::numeric_limits<IntType>::min());
-            double dmax = static_cast<double>(std::numeric_limits<IntType>::max());
-            while (true) {
-                x = normal_dist(engine);
-                if (dmin < x && x < dmax) break; // drop out-of-range values, range (min, max) is open for safety
-            }
+public:
+    template<class Engine>
+    Distribution(const std::string& _dist, Engine& _engine)
+        : shape(parse(_dist)),
+          uniform(std::numeric_limits<IntType>::min(), std::numeric_limits<IntType>::max()) {
+        const double lo = std::numeric_limits<IntType>::min(), hi = std::numeric_limits<IntType>::max();
+        if (shape == NORMAL) {
+            double mu = (std::numeric_limits<IntType>::max() + std::numeric_limits<IntType>::min()) / 2.;
+            double sd = ((std::numeric_limits<IntType>::max() >> 1) / 4.) - ((std::numeric_limits<IntType>::min() >> 1) / 4.); // 4sigma ~ 99.994%
+            normal1 = std::normal_distribution<double>(mu, sd);
+        } else if (shape == BIMODAL) {
+            double sd = ((std::numeric_limits<IntType>::max() >> 2) / 4.) - ((std::numeric_limits<IntType>::min() >> 2) / 4.); // extra shifting (half domain)
+            normal1 = std::normal_distribution<double>(lo + (hi - lo) * (1. / 4), sd); // quarter points of the domain, also for signed keys
+            normal2 = std::normal_distribution<double>(lo + (hi - lo) * (3. / 4), sd);
+        } else if (shape == EXPONENTIAL) {
+            exponential = std::exponential_distribution<double>(6. / (hi - lo));
+        } else if (shape == CONSTANT) {
+            constant = uniform(_engine);
+        } else if (shape == FEWUNIQUE) {
+            for (std::size_t i = 0; i < 5; ++i) uniques.push_back(uniform(_engine));
+            index = std::uniform_int_distribution<std::size_t>(0, uniques.size() - 1);
+        }
+    }
+
+    template<class Engine>
+    IntType operator()(Engine& _engine) {
+        const double dmin = static_cast<double>(std::numeric_limits<IntType>::min());
+        const double dmax = static_cast<double>(std::numeric_limits<IntType>::max());
+        double x;
+        switch (shape) {
+        case UNIFORM:
+            return uniform(_engine);
+        case NORMAL:
+            do x = normal1(_engine);
+            while (!(dmin < x && x < dmax)); // drop out-of-range values, range (min, max) is open for safety
             return static_cast<IntType>(llround(x));
-        };
-    } else if (dist == "bimodal") {
-        double mu = (std::numeric_limits<IntType>::max() + std::numeric_limits<IntType>::min()) / 2.;
-        double sd = ((std::numeric_limits<IntType>::max() >> 2) / 4.) - ((std::numeric_limits<IntType>::min() >> 2) / 4.); // extra shifting (half domain)
-        double mu1 = mu * (1. / 2);
-        double mu2 = mu * (3. / 2);
-        static std::normal_distribution<double> normal_dist1(mu1, sd);
-        static std::normal_distribution<double> normal_dist2(mu2, sd);
-        distgen = [&]() -> IntType {
-            double x;
-            double dmin = static_cast<double>(std::numeric_limits<IntType>::min());
-            double dmax = static_cast<double>(std::numeric_limits<IntType>::max());
-            while (true) {
-                if (coin_flip(engine)) x = normal_dist1(engine);
-                else                   x = normal_dist2(engine);
-                if (dmin < x && x < dmax) break; // drop out-of-range values, range (min, max) is open for safety
-            }
+        case BIMODAL:
+            do x = coin_flip(_engine) ? normal1(_engine) : normal2(_engine);
+            while (!(dmin < x && x < dmax));
             return static_cast<IntType>(llround(x));
-        };
-    } else if (dist == "exponential") {
-        double lambda = 6. / (std::numeric_limits<IntType>::max() - std::numeric_limits<IntType>::min());
-        static std::exponential_distribution<double> exp_dist(lambda);
-        distgen = [&]() -> IntType {
-            double x;
-            double dmin = static_cast<double>(std::numeric_limits<IntType>::min());
-            double dmax = static_cast<double>(std::numeric_limits<IntType>::max());
-            while (true) {
-                x = exp_dist(engine);
-                if (dmin < x && x < dmax) break;
-            }
+        case EXPONENTIAL:
+            do x = dmin + exponential(_engine); // decays from the bottom of the domain
+            while (!(dmin < x && x < dmax));
             return static_cast<IntType>(llround(x));
-        };
-    } else if (dist == "constant") {
-        static IntType constant = std::uniform_int_distribution<IntType>(std::numeric_limits<IntType>::min(), std::numeric_limits<IntType>::max())(engine);
-        distgen = [&]() -> IntType {
+        case CONSTANT:
             return constant;
-        };
-    } else if (dist == "fewunique") {
-        std::uniform_int_distribution<IntType> uniform(std::numeric_limits<IntType>::min(), std::numeric_limits<IntType>::max());
-        static std::vector<IntType> uniques;
-        for (std::size_t i = 0; i < 5; ++i) uniques.push_back(uniform(engine));
-        static std::uniform_int_distribution<std::size_t> index(0, uniques.size() -1);
-        distgen = [&]() -> IntType {
-            return uniques[index(engine)];
-        };
-    } else { throw std::runtime_error("Unsupported distribution: " + dist); }
-    
-    if (verbose) std::cout << "Generating..."; // TODO: add progress bar
-    Stream<IntType> unsorted(dest + ".unsorted");
-    std::vector<IntType> list(iter);
-    for (std::size_t i = 0; i < iter; ++i) list[i] = distgen();
-    if (!randomly_generated) std::shuffle(list.begin(), list.end(), engine);
-    if (verbose) std::cout << " [Done]\n";
+        case FEWUNIQUE:
+            return uniques[index(_engine)];
+        }
+        return IntType();
+    }
 
+private:
+    Shape shape;
+    std::uniform_int_distribution<IntType> uniform;
+    std::normal_distribution<double> normal1, normal2;
+    std::exponential_distribution<double> exponential;
+    IntType constant = IntType();
+    std::vector<IntType> uniques;
+    std::uniform_int_distribution<std::size_t> index;
+};
+
+// rearranges generated keys into the requested pattern, the randomness of the pattern itself comes from engine
+template<class IntType>
+void fit_pattern(std::vector<IntType>& list, const std::string& pattern, std::mt19937& engine, bool verbose=false) {
     if (verbose) std::cout << "Fitting in " << pattern << " pattern...";
     if (pattern == "random") {
         // pass
@@ -175,14 +181,234 @@ void generate(const std::size_t& iter,
         for (std::size_t i = 0, j = list.size() / 2; j < list.size(); i += 2, j += 2) std::swap(list[i], list[j]);
     }
     if (verbose) std::cout << " [Done]\n";
+}
+
+template<class IntType>
+std::vector<IntType> generate(const std::size_t& iter,
+                              const std::string& dist,
+                              const std::string& pattern,
+                              std::mt19937& engine,
+                              bool verbose=false) {
+    Distribution<IntType> distgen(dist, engine);
+    bool randomly_generated = true;
+
+    if (verbose) std::cout << "Generating..."; // TODO: add progress bar
+    std::vector<IntType> list(iter);
+    for (std::size_t i = 0; i < iter; ++i) list[i] = distgen(engine);
+    if (!randomly_generated) std::shuffle(list.begin(), list.end(), engine);
+    if (verbose) std::cout << " [Done]\n";
+
+    fit_pattern(list, pattern, engine, verbose);
+    return list;
+}
+
+// integer keys are generated directly, floats are scaled from signed integers so every pattern keeps its order
+template<class T> struct Raw { using type = T; };
+template<> struct Raw<float>  { using type = std::int32_t; };
+template<> struct Raw<double> { using type = std::int64_t; };
+template<class Key, std::size_t Payload> struct Raw<Record<Key, Payload>> { using type = typename Raw<Key>::type; };
+
+template<class Key, class IntType>
+inline Key to_key(IntType _raw) {
+    if constexpr (std::is_floating_point_v<Key>) return Key(_raw) / Key(std::numeric_limits<IntType>::max()); // [-1, 1]
+    else return static_cast<Key>(_raw);
+}
+
+template<class T, class IntType>
+inline T make_element(IntType _raw, std::uint64_t _index) {
+    T element;
+    if constexpr (is_record_v<T>) { // payload holds the original position, so stability can be checked
+        element.key = to_key<key_type_t<T>>(_raw);
+        std::memset(element.payload, 0, sizeof(element.payload));
+        std::memcpy(element.payload, &_index, std::min(sizeof(_index), sizeof(element.payload)));
+    }
+    else element = to_key<T>(_raw);
+    return element;
+}
 
-    for (std::size_t i = 0; i < iter; ++i) unsorted << list[i];
-    unsorted.flush();
+template<class T>
+inline bool key_less(const T& _a, const T& _b)
+{ return key_of(_a) < key_of(_b); }
 
-    Stream<IntType> sorted(dest + ".sorted");
-    std::sort(list.begin(), list.end());
-    for (auto i : list) sorted << i;
-    sorted.flush();
+// stable, so records of equal keys keep their index order: blocks are sorted in parallel, then merged pairwise
+template<class T>
+void sort_answer(ThreadPool& pool, std::vector<T>& data, std::size_t block) {
+    const std::size_t N = data.size();
+    parallel_for(pool, (N + block - 1) / block, [&](std::size_t b, std::size_t) {
+        std::stable_sort(data.begin() + b * block, data.begin() + std::min(N, (b + 1) * block), key_less<T>);
+    });
+    for (std::size_t width = block; width < N; width *= 2) {
+        parallel_for(pool, (N + 2 * width - 1) / (2 * width), [&](std::size_t m, std::size_t) {
+            std::size_t low = 2 * m * width, mid = std::min(N, low + width), high = std::min(N, low + 2 * width);
+            std::inplace_merge(data.begin() + low, data.begin() + mid, data.begin() + high, key_less<T>);
+        });
+    }
+}
+
+// raw elements as before, or a container when a header template is given
+template<class T>
+void write_elements(const std::vector<T>& data, const std::string& filename, const std::optional<ContainerHeader>& format) {
+    if (format) {
+        ContainerWriter<T> out(filename, *format);
+        for (const auto& x : data) out << x;
+        out.close();
+    } else {
+        Stream<T> out(filename);
+        for (const auto& x : data) out << x;
+        out.flush();
+    }
+}
+
+inline std::optional<ContainerHeader> answer_format(std::optional<ContainerHeader> format) {
+    if (format) format->flags |= CONTAINER_ANSWER;
+    return format;
+}
+
+// k-way merge of sorted run files, ties go to the earlier run so the merge stays stable
+template<class T, class Sink>
+void merge_runs(const std::vector<std::string>& inputs, Sink& out) {
+    using Head = std::pair<T, std::size_t>;
+    auto later = [](const Head& _a, const Head& _b) {
+        if (key_less(_b.first, _a.first)) return true;
+        return !key_less(_a.first, _b.first) && _a.second > _b.second;
+    };
+    std::vector<Source<T>> sources;
+    sources.reserve(inputs.size());
+    for (const auto& input : inputs) sources.emplace_back(input);
+    std::priority_queue<Head, std::vector<Head>, decltype(later)> heads(later);
+    T val;
+    for (std::size_t r = 0; r < sources.size(); ++r)
+        if (sources[r] >> val) heads.emplace(val, r);
+
+    while (!heads.empty()) {
+        std::size_t r = heads.top().second;
+        out << heads.top().first;
+        heads.pop();
+        if (sources[r] >> val) heads.emplace(val, r);
+    }
+}
+
+// writes the keys generated in memory, their fingerprint and, unless skipped, their stable answer
+template<class T>
+void produce(std::vector<typename Raw<T>::type> list,
+             const std::string& dest,
+             ThreadPool& pool,
+             std::size_t block,
+             bool skip_sorted,
+             const std::optional<ContainerHeader>& format,
+             bool verbose=false) {
+    std::vector<T> data(list.size());
+    for (std::size_t i = 0; i < list.size(); ++i) data[i] = make_element<T>(list[i], i);
+    std::vector<typename Raw<T>::type>().swap(list); // never hold both copies and the answer
+
+    write_elements(data, dest + ".unsorted", format);
+
+    Fingerprint fingerprint;
+    fingerprint.add(reinterpret_cast<const std::uint8_t*>(data.data()), data.size(), sizeof(T));
+    fingerprint.save(dest + ".fingerprint");
+    if (skip_sorted) return;
+
+    if (verbose) std::cout << "Sorting the answer...";
+    sort_answer(pool, data, block);
+    write_elements(data, dest + ".sorted", answer_format(format));
+    if (verbose) std::cout << " [Done]\n";
+}
+
+constexpr std::uint64_t SETUP_STREAM = ~std::uint64_t(0); // Philox stream of the distribution setup draws
+constexpr std::size_t MERGE_FAN_IN = 64;                  // run files open at once per merge
+
+// counter-based generation: block b is a pure function of (seed, b), so the output does not depend on the thread count
+template<class T>
+void produce_philox(const std::size_t& iter,
+                    const std::string& dist,
+                    const std::string& pattern,
+                    std::uint64_t seed,
+                    const std::string& dest,
+                    ThreadPool& pool,
+                    std::size_t block,
+                    bool skip_sorted,
+                    const std::optional<ContainerHeader>& format,
+                    bool verbose=false) {
+    using IntType = typename Raw<T>::type;
+    Philox4x32 setup(seed, SETUP_STREAM);
+    const Distribution<IntType> prototype(dist, setup);
+    const std::size_t blocks = (iter + block - 1) / block;
+    if (verbose) std::cout << "Generating " << blocks << " block(s) on " << pool.size() << " thread(s)...";
+
+    if (pattern != "random") { // every other pattern rearranges the whole array, it is generated in memory
+        std::vector<IntType> list(iter);
+        parallel_for(pool, blocks, [&](std::size_t b, std::size_t) {
+            Philox4x32 engine(seed, b);
+            Distribution<IntType> distgen(prototype);
+            for (std::size_t i = b * block; i < std::min(iter, (b + 1) * block); ++i) list[i] = distgen(engine);
+        });
+        if (verbose) std::cout << " [Done]\n";
+        std::mt19937 engine(seed);
+        fit_pattern(list, pattern, engine, verbose);
+        produce<T>(std::move(list), dest, pool, block, skip_sorted, format, verbose);
+        return;
+    }
+
+    // random pattern: blocks go straight to their offset in .unsorted and, sorted, to a run file;
+    // at most one block per thread is held in memory, so a container .unsorted is never compressed
+    const std::string unsorted = dest + ".unsorted";
+    std::optional<ContainerHeader> layout = format;
+    if (layout) layout->flags &= ~CONTAINER_COMPRESSED;
+    const std::size_t start = layout ? layout->offset : 0;
+    { std::ofstream create(unsorted, std::ios::binary); }
+    std::filesystem::resize_file(unsorted, start + iter * sizeof(T));
+    TempDir scratch("datagen", std::filesystem::path(dest).parent_path()); // runs go under --path, sized for the data
+    std::vector<std::string> runs(blocks);
+    std::vector<Fingerprint> fingerprints(blocks);
+    parallel_for(pool, blocks, [&](std::size_t b, std::size_t) {
+        const std::size_t low = b * block, high = std::min(iter, low + block);
+        Philox4x32 engine(seed, b);
+        Distribution<IntType> distgen(prototype);
+        std::vector<T> data(high - low);
+        for (std::size_t i = low; i < high; ++i) data[i - low] = make_element<T>(distgen(engine), i);
+
+        std::fstream fout(unsorted, std::ios::in | std::ios::out | std::ios::binary);
+        fout.seekp(start + low * sizeof(T));
+        fout.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(T));
+        if (!fout) throw std::runtime_error("Cannot write the file: " + unsorted);
+        fingerprints[b].add(reinterpret_cast<const std::uint8_t*>(data.data()), data.size(), sizeof(T));
+        if (skip_sorted) return;
+
+        std::stable_sort(data.begin(), data.end(), key_less<T>);
+        runs[b] = scratch / ("run" + std::to_string(b));
+        Stream<T> run(runs[b]);
+        for (const auto& x : data) run << x;
+    });
+    if (layout) seal_container(unsorted, *layout);
+    if (verbose) std::cout << " [Done]\n";
+
+    Fingerprint fingerprint;
+    for (const auto& fp : fingerprints) fingerprint += fp;
+    fingerprint.save(dest + ".fingerprint");
+    if (skip_sorted) return;
+
+    if (verbose) std::cout << "Merging " << runs.size() << " run(s)...";
+    for (std::size_t pass = 0; runs.size() > MERGE_FAN_IN; ++pass) { // consecutive groups, order is kept for stability
+        std::vector<std::string> merged((runs.size() + MERGE_FAN_IN - 1) / MERGE_FAN_IN);
+        parallel_for(pool, merged.size(), [&](std::size_t g, std::size_t) {
+            std::vector<std::string> group(runs.begin() + g * MERGE_FAN_IN,
+                                           runs.begin() + std::min(runs.size(), (g + 1) * MERGE_FAN_IN));
+            merged[g] = scratch / ("pass" + std::to_string(pass) + "_" + std::to_string(g));
+            Stream<T> out(merged[g]);
+            merge_runs<T>(group, out);
+            for (const auto& run : group) std::filesystem::remove(run);
+        });
+        runs.swap(merged);
+    }
+    if (auto sorted = answer_format(format)) {
+        ContainerWriter<T> out(dest + ".sorted", *sorted);
+        merge_runs<T>(runs, out);
+        out.close();
+    } else {
+        Stream<T> out(dest + ".sorted");
+        merge_runs<T>(runs, out);
+    }
+    if (verbose) std::cout << " [Done]\n";
 }
 
 int main(int argc, char** argv) {
@@ -215,10 +441,42 @@ int main(int argc, char** argv) {
         .choices(8, 16, 32, 64)
         .default_value((std::int16_t)32);
 
+    args.add_argument("--type") // int: unsigned, sint: signed, float: IEEE 754 (32/64 bits)
+        .choices("int", "sint", "float")
+        .default_value(std::string("int"));
+
+    args.add_argument("--payload") // bytes of index payload after each key, records need 32/64-bit keys (32/128: int only)
+        .scan<'i', int>()
+        .choices(0, 8, 32, 128)
+        .default_value(0);
+
     args.add_argument("--seed")
         .scan<'i', std::int64_t>()
         .default_value((std::int64_t)std::random_device()());
     
+    args.add_argument("--rng") // mt19937: single sequential stream (default, reproduces earlier datasets), philox: counter-based blocks
+        .choices("mt19937", "philox")
+        .default_value(std::string("mt19937"));
+
+    args.add_argument("--threads") // generation (philox) and answer sorting
+        .scan<'u', std::size_t>()
+        .default_value(std::size_t(std::max(1u, std::thread::hardware_concurrency())));
+
+    args.add_argument("--block") // elements per generator block and sorted run, fixed for reproducible philox output
+        .default_value(std::string("4M"));
+
+    args.add_argument("--skip-sorted") // benchmark then validates by sortedness and the .fingerprint sidecar
+        .default_value(false)
+        .implicit_value(true);
+
+    args.add_argument("--container") // self-describing header before the elements, 64-byte aligned for mmap
+        .default_value(false)
+        .implicit_value(true);
+
+    args.add_argument("--compress") // delta-coded container blocks, pays off for sorted and almost sorted data
+        .default_value(false)
+        .implicit_value(true);
+
     // args.add_argument("--almost")
     //     .scan<'i', int>()
     //     .default_value(0);
@@ -241,34 +499,57 @@ int main(int argc, char** argv) {
     const std::size_t iter = parse_suffix(iter_suffix);
     const std::int64_t seed = args.get<std::int64_t>("--seed");
     const std::int16_t bsize = args.get<std::int16_t>("--bsize");
+    const KeyKind kind = parse_kind(args.get<std::string>("--type"));
+    const std::size_t payload = args.get<int>("--payload");
     const std::string dist = args.get<std::string>("--dist");
     const std::string pattern = args.get<std::string>("--pattern");
     const std::filesystem::path path = std::filesystem::absolute(args.get<std::string>("--path"));
     const bool verbose = args.get<bool>("--verbose");
+    const std::string rng = args.get<std::string>("--rng");
+    const std::size_t block = std::max<std::size_t>(parse_suffix(args.get<std::string>("--block")), 1);
+    ThreadPool pool(args.get<std::size_t>("--threads"));
+    const bool skip_sorted = args.get<bool>("--skip-sorted");
+    const bool compress = args.get<bool>("--compress");
+    const bool container = args.get<bool>("--container") || compress;
 
-    std::mt19937 engine(seed);
-    std::string dest = std::format("int{}_{}_{}_{}", bsize, iter_suffix, dist, pattern);
+    const std::string type = kind_prefix(kind) + std::to_string(bsize) + (payload ? "p" + std::to_string(payload) : std::string());
+    std::string dest = std::format("{}_{}_{}_{}", type, iter_suffix, dist, pattern);
     dest = resolve_duplicated(path, dest);
 
     if (verbose) {
         std::cout << std::fixed << std::setprecision(4);
         std::cout << "======================= SUMMARY =======================\n"
                   << "  Random Seed : " << seed << "\n"
+                  << "          RNG : " << rng << " (" << pool.size() << " threads, " << block << " per block)\n"
                   << " Distribution : " << dist << "\n"
                   << "   Iterations : " << iter << "\n"
-                  << "   Data Range : " << "[0, 2^" << bsize << "-1]\n"
-                  << "    Data Size : " << bsize / 8 << " Bytes\n"
-                  << "  Target Size : " << iter * bsize / 8388608. << " MiB\n"
+                  << "     Key Type : " << type << "\n"
+                  << "    Data Size : " << bsize / 8 + payload << " Bytes\n"
+                  << "  Target Size : " << iter * (bsize / 8 + payload) / 1048576. << " MiB\n"
                   << "       Target : " << dest << ".*\n"
+                  << "       Format : " << (compress ? "compressed container" : container ? "container" : "raw") << "\n"
                   << "=======================================================\n";
     }
 
-    switch (bsize) {
-    case  8: generate<std::uint8_t >(iter, dist, pattern, engine, path / dest, verbose); break;
-    case 16: generate<std::uint16_t>(iter, dist, pattern, engine, path / dest, verbose); break;
-    case 32: generate<std::uint32_t>(iter, dist, pattern, engine, path / dest, verbose); break;
-    case 64: generate<std::uint64_t>(iter, dist, pattern, engine, path / dest, verbose); break;
+    std::optional<ContainerHeader> format;
+    if (container) {
+        format = make_header(kind, bsize, payload, iter, dist, pattern);
+        format->rng = rng == "philox" ? RNG_PHILOX : RNG_MT19937;
+        format->generator = GENERATOR_VERSION;
+        format->gen_block = block;
+        format->seed = seed;
+        if (compress) format->flags |= CONTAINER_COMPRESSED;
     }
 
+    visit_key_type(kind, bsize, payload, [&](auto _tag) {
+        using T = typename decltype(_tag)::type;
+        if (rng == "philox") {
+            produce_philox<T>(iter, dist, pattern, seed, path / dest, pool, block, skip_sorted, format, verbose);
+        } else {
+            std::mt19937 engine(seed);
+            produce<T>(generate<typename Raw<T>::type>(iter, dist, pattern, engine, verbose), path / dest, pool, block, skip_sorted, format, verbose);
+        }
+    });
+
     return 0;
 }
\ No newline at end of file